@@ -0,0 +1,165 @@
+#include "AssetLoader.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "Mesh.h"
+#include "MeshCache.h"
+#include "TextureCache.h"
+
+// Core
+#include "Core/JobSystem.h"
+
+//------------------------------------------------------------------------------
+static constexpr int32_t kPlaceholderTextureSize = 8;
+static constexpr uint32_t kPlaceholderColors[2] = { 0x808080FF, 0xC0C0C0FF };
+
+//------------------------------------------------------------------------------
+AssetLoader::AssetLoader(JobSystem& jobSystem)
+    : mJobSystem(jobSystem)
+    , mShutdown(false)
+{
+    // Start the thread last, it reads the members
+    mThread = std::thread(&AssetLoader::LoaderLoop, this);
+}
+
+//------------------------------------------------------------------------------
+AssetLoader::~AssetLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mShutdown = true;
+    }
+    mWakeCondition.notify_all();
+    mThread.join();
+}
+
+//------------------------------------------------------------------------------
+AssetHandle<Mesh> AssetLoader::RequestMesh(const fs::path& sourcePath)
+{
+    AssetHandle<Mesh> handle;
+    handle.mState = std::make_shared<AssetHandle<Mesh>::State>();
+
+    Enqueue([this, sourcePath, state = handle.mState]()
+    {
+        state->mAsset = LoadMesh(sourcePath, mJobSystem);
+        state->mReady.store(true, std::memory_order_release);
+    });
+
+    return handle;
+}
+
+//------------------------------------------------------------------------------
+AssetHandle<Texture> AssetLoader::RequestTexture(const fs::path& sourcePath, TextureLayout layout, TextureFormat format)
+{
+    AssetHandle<Texture> handle;
+    handle.mState = std::make_shared<AssetHandle<Texture>::State>();
+
+    Enqueue([sourcePath, layout, format, state = handle.mState]()
+    {
+        state->mAsset = LoadTexture(sourcePath, layout, format);
+        state->mReady.store(true, std::memory_order_release);
+    });
+
+    return handle;
+}
+
+//------------------------------------------------------------------------------
+void AssetLoader::Enqueue(std::function<void()> request)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRequests.push_back(std::move(request));
+    }
+    mWakeCondition.notify_one();
+}
+
+//------------------------------------------------------------------------------
+void AssetLoader::LoaderLoop()
+{
+    // Jobs of the loads go to a queue of their own instead of the one of the render thread
+    mJobSystem.RegisterThread();
+
+    while (true)
+    {
+        std::function<void()> request;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWakeCondition.wait(lock, [this] { return mShutdown || !mRequests.empty(); });
+
+            if (mShutdown)
+            {
+                break;
+            }
+
+            request = std::move(mRequests.front());
+            mRequests.pop_front();
+        }
+
+        request();
+        mJobSystem.GetScratchArena().Reset();
+    }
+
+    mJobSystem.UnregisterThread();
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<Mesh> CreatePlaceholderMesh()
+{
+    static const std::vector<glm::vec2> kUvs = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+    // Every side has its own corners, the generated normals stay flat across the edges
+    std::vector<glm::vec3> vertices;
+    std::vector<Face> faces;
+    for (int32_t axis = 0; axis < 3; axis++)
+    {
+        for (float sign : { -1.0f, 1.0f })
+        {
+            glm::vec3 normal(0.0f);
+            glm::vec3 tangent(0.0f);
+            glm::vec3 bitangent(0.0f);
+            normal[axis] = sign;
+            tangent[(axis + 1) % 3] = 1.0f;
+            bitangent[(axis + 2) % 3] = 1.0f;
+
+            const int32_t base = static_cast<int32_t>(vertices.size());
+            vertices.push_back(normal - tangent - bitangent);
+            vertices.push_back(normal + tangent - bitangent);
+            vertices.push_back(normal + tangent + bitangent);
+            vertices.push_back(normal - tangent + bitangent);
+
+            // Front faces wind so that cross(B - A, C - A) points outwards, cross(tangent, bitangent) points along +axis
+            const std::array<int32_t, 6> corners = sign > 0.0f ? std::array<int32_t, 6> { 0, 1, 2, 0, 2, 3 } : std::array<int32_t, 6> { 0, 2, 1, 0, 3, 2 };
+            for (size_t i = 0; i < corners.size(); i += 3)
+            {
+                Face face;
+                for (size_t j = 0; j < 3; j++)
+                {
+                    face.mVertexIndicies[j] = base + corners[i + j];
+                    face.mTextureIndicies[j] = corners[i + j];
+                    face.mNormalIndicies[j] = kMissingFaceIndex;
+                }
+                faces.push_back(face);
+            }
+        }
+    }
+
+    std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>();
+    mesh->Load(vertices, { }, kUvs, faces);
+    return mesh;
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<Texture> CreatePlaceholderTexture()
+{
+    std::vector<uint32_t> pixels(kPlaceholderTextureSize * kPlaceholderTextureSize);
+    for (int32_t y = 0; y < kPlaceholderTextureSize; y++)
+    {
+        for (int32_t x = 0; x < kPlaceholderTextureSize; x++)
+        {
+            pixels[y * kPlaceholderTextureSize + x] = kPlaceholderColors[(x + y) & 1];
+        }
+    }
+
+    return std::make_unique<Texture>(std::move(pixels), glm::ivec2(kPlaceholderTextureSize), TextureLayout::Tiled);
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "Texture.h"
+
+// System
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Forward Declarations
+//------------------------------------------------------------------------------
+class JobSystem;
+class Mesh;
+
+// Type Alias
+//------------------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+/*
+    Asset that is loaded in the background. The handle is ready once the loader is done with
+    it, the asset is null if loading failed. Until then the caller draws a placeholder, so a
+    load never stalls a frame. Handles share their state with the loader and may be dropped
+    before the asset arrives.
+*/
+//------------------------------------------------------------------------------
+template<typename Asset>
+class AssetHandle
+{
+public:
+    bool IsValid() const { return mState != nullptr; }
+    bool IsReady() const { return mState != nullptr && mState->mReady.load(std::memory_order_acquire); }
+
+    // The loaded asset, or fallback while it is loading and when it failed to load
+    Asset* GetOr(Asset* fallback) const
+    {
+        return IsReady() && mState->mAsset != nullptr ? mState->mAsset.get() : fallback;
+    }
+
+private:
+    friend class AssetLoader;
+
+    struct State
+    {
+        std::unique_ptr<Asset> mAsset;
+        std::atomic<bool> mReady = false;  // Publishes mAsset
+    };
+
+    std::shared_ptr<State> mState;
+};
+
+/*
+    Loads meshes and textures on a dedicated thread, one request at a time in the order they
+    were made. Requests go through the asset caches, see MeshCache.h and TextureCache.h. The
+    loader thread is registered with the job system, so the OBJ parser of a cache miss queues
+    its chunks on the loader's own queue where only the workers and the loader run them.
+    Pending requests are dropped when the loader is destroyed, the job system has to outlive it.
+*/
+//------------------------------------------------------------------------------
+class AssetLoader
+{
+public:
+    explicit AssetLoader(JobSystem& jobSystem);
+    ~AssetLoader();
+
+    AssetHandle<Mesh> RequestMesh(const fs::path& sourcePath);
+    AssetHandle<Texture> RequestTexture(const fs::path& sourcePath, TextureLayout layout = TextureLayout::Linear,
+                                        TextureFormat format = TextureFormat::RGBA8);
+
+    // Delete copy and assignment, the loader thread holds a pointer to this instance
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+private:
+    void Enqueue(std::function<void()> request);
+    void LoaderLoop();
+
+    JobSystem& mJobSystem;
+    std::deque<std::function<void()>> mRequests;
+    std::mutex mMutex;
+    std::condition_variable mWakeCondition;
+    bool mShutdown;
+    std::thread mThread;
+};
+
+//------------------------------------------------------------------------------
+// Drawn in place of assets that have not arrived yet: a cube of side 2 around the origin and a gray checkerboard
+std::unique_ptr<Mesh> CreatePlaceholderMesh();
+std::unique_ptr<Texture> CreatePlaceholderTexture();
\ No newline at end of file
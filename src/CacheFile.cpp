@@ -0,0 +1,40 @@
+#include "CacheFile.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <array>
+
+//------------------------------------------------------------------------------
+bool QueryCacheFileSource(const fs::path& sourcePath, CacheFileSource& outSource)
+{
+    std::error_code error;
+    outSource.mSize = fs::file_size(sourcePath, error);
+    if (error)
+    {
+        return false;
+    }
+
+    const fs::file_time_type writeTime = fs::last_write_time(sourcePath, error);
+    outSource.mWriteTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    return !error;
+}
+
+//------------------------------------------------------------------------------
+uint64_t AlignCacheOffset(uint64_t offset)
+{
+    return (offset + kCacheFileAlignment - 1) / kCacheFileAlignment * kCacheFileAlignment;
+}
+
+//------------------------------------------------------------------------------
+void WriteCachePadding(std::ofstream& file, uint64_t offset)
+{
+    static constexpr std::array<char, kCacheFileAlignment> kZeros = { };
+    file.write(kZeros.data(), AlignCacheOffset(offset) - offset);
+}
+
+//------------------------------------------------------------------------------
+bool IsCacheBlockValid(uint64_t offset, uint64_t size, uint64_t headerSize, uint64_t fileSize)
+{
+    return offset % kCacheFileAlignment == 0 && offset >= headerSize && offset <= fileSize && size <= fileSize - offset;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+// Type Alias
+//------------------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+// Constants
+//------------------------------------------------------------------------------
+// Blocks of the binary asset caches start on a cache line, a mapped block can be read with aligned loads
+constexpr uint64_t kCacheFileAlignment = 64;
+
+/*
+    Helpers shared by the binary asset caches, see MeshCache.h and TextureCache.h. A cache
+    records the size and write time of its source file and counts as stale once they change.
+*/
+//------------------------------------------------------------------------------
+struct CacheFileSource
+{
+    uint64_t mSize = 0;
+    int64_t mWriteTime = 0;
+};
+
+//------------------------------------------------------------------------------
+bool QueryCacheFileSource(const fs::path& sourcePath, CacheFileSource& outSource);
+uint64_t AlignCacheOffset(uint64_t offset);
+
+// Writes zeros from offset up to the next aligned offset
+void WriteCachePadding(std::ofstream& file, uint64_t offset);
+
+// The block is aligned, behind the header and inside the file
+bool IsCacheBlockValid(uint64_t offset, uint64_t size, uint64_t headerSize, uint64_t fileSize);
\ No newline at end of file
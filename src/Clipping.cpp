@@ -5,99 +5,122 @@
 // System
 #include <algorithm>
 
-namespace {
+//------------------------------------------------------------------------------
+static float ClipPlaneDistance(ClippingPlaneType type, const glm::vec4& point, const ClipGuardBand& guardBand)
+{
+    // Signed distance (scaled by w) to a clip-space plane, positive on the inside
+    switch (type)
+    {
+        case ClippingPlaneType::NEAR:   return point.z;
+        case ClippingPlaneType::FAR:    return point.w - point.z;
+        case ClippingPlaneType::LEFT:   return guardBand.mX * point.w + point.x;
+        case ClippingPlaneType::RIGHT:  return guardBand.mX * point.w - point.x;
+        case ClippingPlaneType::TOP:    return guardBand.mY * point.w - point.y;
+        case ClippingPlaneType::BOTTOM: return guardBand.mY * point.w + point.y;
+        default:                        return 0.0f;
+    }
+}
 
-}  // namespace
+//------------------------------------------------------------------------------
+uint8_t ComputeClipOutcode(const glm::vec4& clipPosition, const ClipGuardBand& guardBand)
+{
+    const float x = clipPosition.x;
+    const float y = clipPosition.y;
+    const float z = clipPosition.z;
+    const float w = clipPosition.w;
+    const float extentX = guardBand.mX * w;
+    const float extentY = guardBand.mY * w;
+
+    // Built wide and narrowed once, the conditionals are promoted to int
+    uint32_t outcode = 0;
+    outcode |= (z < 0.0f) ? ClippingPlaneOutcode(ClippingPlaneType::NEAR) : 0;
+    outcode |= (z > w) ? ClippingPlaneOutcode(ClippingPlaneType::FAR) : 0;
+    outcode |= (x < -extentX) ? ClippingPlaneOutcode(ClippingPlaneType::LEFT) : 0;
+    outcode |= (x > extentX) ? ClippingPlaneOutcode(ClippingPlaneType::RIGHT) : 0;
+    outcode |= (y > extentY) ? ClippingPlaneOutcode(ClippingPlaneType::TOP) : 0;
+    outcode |= (y < -extentY) ? ClippingPlaneOutcode(ClippingPlaneType::BOTTOM) : 0;
+
+    return static_cast<uint8_t>(outcode);
+}
 
 //------------------------------------------------------------------------------
-std::array<Plane, 6> ComputePerspectiveFrustrumPlanes(const Angle& fovX, const Angle& fovY, float near, float far)
+ClipOutcodes ComputeClipOutcodes(const glm::vec4& clipPosition, const ClipGuardBand& guardBand)
 {
-    /*            
-              /|\
-            /  | | 
-          /\   | |
-        /      | |
-     P*|-->  <-|*|   ----> +z-axis
-        \      | |
-          \/   | |
-            \  | | 
-              \|/
-    */
-    
-    const float halfFovRadX = fovX.AsRadians() * 0.5f;
-    const float cosHalfFovX = std::cos(halfFovRadX);
-    const float sinHalfFovX = std::sin(halfFovRadX);
-    
-    const float halfFovRadY = fovY.AsRadians() * 0.5f;
-    const float cosHalfFovY = std::cos(halfFovRadY);
-    const float sinHalfFovY = std::sin(halfFovRadY);
-
-	const glm::vec3 origin{ 0.0f, 0.0f, 0.0f };
-
-    std::array<Plane, 6> planes { };
-    
-    planes[ClippingPlaneIndex(ClippingPlaneType::LEFT)] = {
-        origin, {cosHalfFovX, 0.0f, sinHalfFovX}
-    };
-    
-    planes[ClippingPlaneIndex(ClippingPlaneType::RIGHT)] = {
-        origin, {-cosHalfFovX, 0.0f, sinHalfFovX}
-    };
-    
-    planes[ClippingPlaneIndex(ClippingPlaneType::TOP)] = {
-        origin, {0.0f, -cosHalfFovY, sinHalfFovY}
-    };
-    
-    planes[ClippingPlaneIndex(ClippingPlaneType::BOTTOM)] = {
-        origin, {0.0f, cosHalfFovY, sinHalfFovY}
-    };
+    ClipOutcodes outcodes;
+    outcodes.mView = ComputeClipOutcode(clipPosition);
+    outcodes.mGuardBand = ComputeClipOutcode(clipPosition, guardBand);
+    return outcodes;
+}
 
-    planes[ClippingPlaneIndex(ClippingPlaneType::NEAR)] = {
-        {0.0f, 0.0f, near}, {0.0f, 0.0f, 1.0f}
-    };
+//------------------------------------------------------------------------------
+ClipGuardBand ComputeClipGuardBand(const glm::vec2& viewportSize, float maxScreenCoordinate)
+{
+    // Screen position is (ndc + 1) * size / 2. Keep a pixel of margin for rounding in the clipper.
+    const float maxScreenPosition = maxScreenCoordinate - 1.0f;
 
-    planes[ClippingPlaneIndex(ClippingPlaneType::FAR)] = {
-        {0.0f, 0.0f, far}, {0.0f, 0.0f, -1.0f}
+    ClipGuardBand guardBand;
+    guardBand.mX = std::max(1.0f, 2.0f * maxScreenPosition / viewportSize.x - 1.0f);
+    guardBand.mY = std::max(1.0f, 2.0f * maxScreenPosition / viewportSize.y - 1.0f);
+    return guardBand;
+}
+
+//------------------------------------------------------------------------------
+size_t ClipTriangle(const Triangle& triangle, std::span<Triangle, kMaxClippedTriangles> outTriangles, const ClipGuardBand& guardBand)
+{
+    const std::array<ClipOutcodes, 3> outcodes = {
+        ComputeClipOutcodes(triangle.mVertices[0].mPoint, guardBand),
+        ComputeClipOutcodes(triangle.mVertices[1].mPoint, guardBand),
+        ComputeClipOutcodes(triangle.mVertices[2].mPoint, guardBand)
     };
 
-	return planes;
+    return ClipTriangle(triangle, outcodes, outTriangles, guardBand);
 }
 
-std::vector<Triangle> ClipWithFrustum(const std::array<Plane, 6>& planes, const Triangle& triangle)
+//------------------------------------------------------------------------------
+size_t ClipTriangle(const Triangle& triangle, const std::array<ClipOutcodes, 3>& outcodes, std::span<Triangle, kMaxClippedTriangles> outTriangles,
+    const ClipGuardBand& guardBand)
 {
-    // Maximum number of vertices when clipping a triangle against a frustum
-    constexpr size_t kMaxVertices = 10;
+    // Trivial reject, all vertices are outside of the same plane of the view volume
+    if ((outcodes[0].mView & outcodes[1].mView & outcodes[2].mView) != 0)
+    {
+        return 0;
+    }
+
+    // Trivial accept, all vertices are inside near, far and the guard band. Parts outside of the
+    // viewport are discarded by the rasterizer's scissor.
+    const uint8_t straddledPlanes = static_cast<uint8_t>(outcodes[0].mGuardBand | outcodes[1].mGuardBand | outcodes[2].mGuardBand);
+    if (straddledPlanes == 0)
+    {
+        outTriangles[0] = triangle;
+        return 1;
+    }
 
     // Start with the triangle's vertices.
-    std::array<Vertex, kMaxVertices> vertices{};
+    std::array<Vertex, kMaxClippedVertices> vertices;
     vertices[0] = triangle.mVertices[0];
     vertices[1] = triangle.mVertices[1];
     vertices[2] = triangle.mVertices[2];
     size_t vertexCount = 3;
 
-    // Clip the polygon against each plane.
-    for (const auto& plane : planes)
+    // Clip the polygon against each plane that has vertices on both sides (Sutherland-Hodgman).
+    for (size_t planeIndex = 0; planeIndex < ClippingPlaneIndex(ClippingPlaneType::COUNT); planeIndex++)
     {
-        if (vertexCount == 0)
+        const ClippingPlaneType plane = static_cast<ClippingPlaneType>(planeIndex);
+        if ((straddledPlanes & ClippingPlaneOutcode(plane)) == 0)
         {
-            break;
+            continue;
         }
 
-        std::array<Vertex, kMaxVertices> newVertices { };
+        std::array<Vertex, kMaxClippedVertices> newVertices;
         size_t newCount = 0;
 
-        // Lambda to compute the signed distance from a vertex to the plane.
-        auto distance = [&plane](const Vertex& v) -> float {
-            return glm::dot(plane.mNormal, glm::vec3(v.mPoint) - plane.mPoint);
-        };
-
         for (size_t j = 0; j < vertexCount; ++j)
         {
             const Vertex& current = vertices[j];
             const Vertex& next = vertices[(j + 1) % vertexCount];
 
-            const float currentDist = distance(current);
-            const float nextDist = distance(next);
+            const float currentDist = ClipPlaneDistance(plane, current.mPoint, guardBand);
+            const float nextDist = ClipPlaneDistance(plane, next.mPoint, guardBand);
 
             // If the current vertex is inside the plane, add it.
             if (currentDist >= 0.0f)
@@ -109,10 +132,12 @@ std::vector<Triangle> ClipWithFrustum(const std::array<Plane, 6>& planes, const
             if (currentDist * nextDist < 0.0f)
             {
                 const float t = currentDist / (currentDist - nextDist);
-                
+
                 Vertex intersection;
                 intersection.mPoint = glm::mix(current.mPoint, next.mPoint, t);
+                intersection.mNormal = glm::mix(current.mNormal, next.mNormal, t);
                 intersection.mUV = glm::mix(current.mUV, next.mUV, t);
+                intersection.mIntensity = glm::mix(current.mIntensity, next.mIntensity, t);
                 newVertices[newCount++] = intersection;
             }
         }
@@ -120,22 +145,22 @@ std::vector<Triangle> ClipWithFrustum(const std::array<Plane, 6>& planes, const
         // Update vertices with the clipped result.
         std::copy(newVertices.begin(), newVertices.begin() + newCount, vertices.begin());
         vertexCount = newCount;
+
+        if (vertexCount < 3)
+        {
+            return 0;
+        }
     }
 
     // Triangulate the resulting polygon using a triangle fan.
-    std::vector<Triangle> clippedTriangles;
-    if (vertexCount >= 3)
+    for (size_t i = 0; i < vertexCount - 2; ++i)
     {
-        clippedTriangles.reserve(vertexCount - 2);
-        for (size_t i = 0; i < vertexCount - 2; ++i)
-        {
-            Triangle clippedTriangle;
-            clippedTriangle.mVertices[0] = vertices[0];
-            clippedTriangle.mVertices[1] = vertices[i + 1];
-            clippedTriangle.mVertices[2] = vertices[i + 2];
-            clippedTriangles.push_back(clippedTriangle);
-        }
+        Triangle& clippedTriangle = outTriangles[i];
+        clippedTriangle.mVertices[0] = vertices[0];
+        clippedTriangle.mVertices[1] = vertices[i + 1];
+        clippedTriangle.mVertices[2] = vertices[i + 2];
+        clippedTriangle.mColor = triangle.mColor;
     }
 
-    return clippedTriangles;
+    return vertexCount - 2;
 }
\ No newline at end of file
@@ -8,13 +8,10 @@
 // Third party
 #include <glm/glm.hpp>
 
-// Core
-#include "Core/Angle.h"
-
 // System
 #include <cstdint>
 #include <array>
-#include <vector>
+#include <span>
 
 //------------------------------------------------------------------------------
 enum class ClippingPlaneType : uint8_t
@@ -29,18 +26,61 @@ enum class ClippingPlaneType : uint8_t
 };
 
 //------------------------------------------------------------------------------
-struct Plane
+constexpr size_t ClippingPlaneIndex(ClippingPlaneType type)
 {
-	glm::vec3 mPoint;
-	glm::vec3 mNormal;
-};
+    return static_cast<size_t>(type);
+}
 
 //------------------------------------------------------------------------------
-constexpr size_t ClippingPlaneIndex(ClippingPlaneType type)
+// Outcode bit set for a vertex outside of the given plane
+constexpr uint8_t ClippingPlaneOutcode(ClippingPlaneType type)
 {
-    return static_cast<size_t>(type);
+    return static_cast<uint8_t>(1u << ClippingPlaneIndex(type));
 }
 
+// Constants
+//------------------------------------------------------------------------------
+// Clipping a triangle against six planes adds at most one vertex per plane, the fan of the
+// resulting polygon has at most kMaxClippedVertices - 2 triangles
+constexpr size_t kMaxClippedVertices = 9;
+constexpr size_t kMaxClippedTriangles = kMaxClippedVertices - 2;
+
+//------------------------------------------------------------------------------
+// Half extents of the region the side planes clip against, in normalized device coordinates.
+// The default is the viewport itself, larger values leave the screen edges to the rasterizer's scissor.
+struct ClipGuardBand
+{
+    float mX = 1.0f;
+    float mY = 1.0f;
+};
+
+/*
+    Clipping runs in homogeneous clip space, before the perspective divide. A vertex is inside
+    the view volume when -w <= x <= w, -w <= y <= w and 0 <= z <= w. The outcode of a vertex has
+    one bit per plane it lies outside of.
+*/
+//------------------------------------------------------------------------------
+uint8_t ComputeClipOutcode(const glm::vec4& clipPosition, const ClipGuardBand& guardBand = { });
+
 //------------------------------------------------------------------------------
-std::array<Plane, 6> ComputePerspectiveFrustrumPlanes(const Angle& fovX, const Angle& fovY, float near, float far);
-std::vector<Triangle> ClipWithFrustum(const std::array<Plane, 6>& planes, const Triangle& triangle);
\ No newline at end of file
+// Outcodes of a vertex against the view volume and against the guard band
+struct ClipOutcodes
+{
+    uint8_t mView = 0;
+    uint8_t mGuardBand = 0;
+};
+
+//------------------------------------------------------------------------------
+ClipOutcodes ComputeClipOutcodes(const glm::vec4& clipPosition, const ClipGuardBand& guardBand);
+
+// Largest guard band whose screen positions stay within +/- maxScreenCoordinate pixels
+ClipGuardBand ComputeClipGuardBand(const glm::vec2& viewportSize, float maxScreenCoordinate);
+
+// Writes the triangles covering the part of the clip-space triangle inside the view volume to outTriangles
+// and returns their count. Triangles outside of one viewport plane produce nothing. Triangles inside near,
+// far and the guard band are copied as is, the rest are clipped against the planes they straddle.
+size_t ClipTriangle(const Triangle& triangle, std::span<Triangle, kMaxClippedTriangles> outTriangles, const ClipGuardBand& guardBand = { });
+
+// Same as above for vertices whose outcodes were already computed by the vertex stage
+size_t ClipTriangle(const Triangle& triangle, const std::array<ClipOutcodes, 3>& outcodes, std::span<Triangle, kMaxClippedTriangles> outTriangles,
+    const ClipGuardBand& guardBand);
\ No newline at end of file
@@ -27,6 +27,10 @@ public:
     void SetPixel(int32_t x, int32_t y, uint32_t color);
     void Render();
 
+    // Unchecked access for rasterizers that already clip to the buffer bounds
+    uint32_t* GetPixelRow(int32_t y) { return mFrameBuffer.data() + y * mSize.x; }
+    const glm::uvec2& GetSize() const { return mSize; }
+
 private:
     AppContext& mContext;
     glm::uvec2 mSize;
@@ -4,6 +4,7 @@
 //------------------------------------------------------------------------------
 // Core
 #include "Core/AppConfig.h"
+#include "Core/JobSystem.h"
 #include "Core/SDLWrappers/SDLWindow.h"
 #include "Core/SDLWrappers/SDLRenderer.h"
 
@@ -16,6 +17,7 @@ struct AppContext
 {
     SDLWindow mWindow;
     SDLRenderer mRenderer;
+    JobSystem mJobSystem;  // Shared by every stage that runs work in parallel
 
     explicit AppContext(const AppConfig& config)
         : mWindow(config)
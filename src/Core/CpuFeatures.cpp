@@ -0,0 +1,40 @@
+#include "Core/CpuFeatures.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#if CPU_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+static bool DetectAVX2()
+{
+#if CPU_X86 && defined(_MSC_VER)
+    int32_t info[4] = { };
+
+    // The CPU has to support AVX and the OS has to save the YMM registers on context switches
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif CPU_X86 && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+bool CpuSupportsAVX2()
+{
+    static const bool supported = DetectAVX2();
+    return supported;
+}
\ No newline at end of file
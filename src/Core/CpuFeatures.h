@@ -0,0 +1,32 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+// SSE2 is part of the x64 baseline, kernels that only need SSE2 are compiled in without a runtime query
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CPU_SSE2 1
+#else
+#define CPU_SSE2 0
+#endif
+
+// Kernels for instruction sets above the build's baseline are compiled per function and only
+// called after the matching Cpu* query succeeded. MSVC accepts the intrinsics without a flag.
+#if CPU_X86 && (defined(__GNUC__) || defined(__clang__))
+#define CPU_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CPU_TARGET_AVX2
+#endif
+
+//------------------------------------------------------------------------------
+// Runtime queries, the CPU is inspected once and the result cached
+bool CpuSupportsAVX2();
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "Core/FrameArena.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+FrameArena::FrameArena(size_t initialCapacity)
+    : mOffset(0)
+    , mUsedBytes(0)
+    , mCapacity(0)
+{
+    AddBlock(initialCapacity);
+}
+
+//------------------------------------------------------------------------------
+static size_t AlignOffset(const std::byte* base, size_t offset, size_t alignment)
+{
+    // Align the address rather than the offset, so alignments above the block's own alignment work too
+    const uintptr_t address = reinterpret_cast<uintptr_t>(base) + offset;
+    const uintptr_t alignedAddress = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    return offset + static_cast<size_t>(alignedAddress - address);
+}
+
+//------------------------------------------------------------------------------
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    size_t alignedOffset = AlignOffset(mBlocks.back().mData.get(), mOffset, alignment);
+
+    if (alignedOffset + size > mBlocks.back().mSize)
+    {
+        // Chain a new block, at least doubling the capacity so the number of blocks stays small
+        AddBlock(std::max(size + alignment, mCapacity));
+        alignedOffset = AlignOffset(mBlocks.back().mData.get(), 0, alignment);
+    }
+
+    mUsedBytes += size;
+    mOffset = alignedOffset + size;
+    return mBlocks.back().mData.get() + alignedOffset;
+}
+
+//------------------------------------------------------------------------------
+void FrameArena::Reset()
+{
+    // Merge the blocks of a frame that outgrew the arena so the next frame fits into one block
+    if (mBlocks.size() > 1)
+    {
+        const size_t capacity = mCapacity;
+        mBlocks.clear();
+        mCapacity = 0;
+        AddBlock(capacity);
+    }
+
+    mOffset = 0;
+    mUsedBytes = 0;
+}
+
+//------------------------------------------------------------------------------
+void FrameArena::AddBlock(size_t minimumSize)
+{
+    mBlocks.push_back({ std::make_unique_for_overwrite<std::byte[]>(minimumSize), minimumSize });
+    mCapacity += minimumSize;
+    mOffset = 0;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+    Linear allocator for data that only lives for one frame. Allocations bump an offset and are
+    never freed individually; Reset releases everything at once. When a frame outgrows the current
+    block, further blocks are chained and merged into a single block on the next reset, so after
+    warm-up a frame allocates nothing from the heap.
+*/
+//------------------------------------------------------------------------------
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t initialCapacity = 1 << 20);
+
+    void* Allocate(size_t size, size_t alignment);
+    void Reset();  // Invalidates every allocation made since the previous reset
+
+    size_t GetUsedBytes() const { return mUsedBytes; }
+    size_t GetCapacity() const { return mCapacity; }
+
+    // Delete copy and assignment, allocations point into the blocks owned by this instance
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> mData;
+        size_t mSize;
+    };
+
+    void AddBlock(size_t minimumSize);
+
+    std::vector<Block> mBlocks;
+    size_t mOffset;     // Offset into the last block
+    size_t mUsedBytes;  // Bytes handed out since the previous reset
+    size_t mCapacity;   // Total size of all blocks
+};
+
+/*
+    Standard allocator adapter so standard containers can live in a FrameArena. Deallocation is a
+    no-op, memory is reclaimed when the arena resets. Containers must be discarded before that.
+*/
+//------------------------------------------------------------------------------
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    ArenaAllocator(FrameArena& arena) : mArena(&arena) { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : mArena(other.GetArena()) { }
+
+    T* allocate(size_t count) { return static_cast<T*>(mArena->Allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T* pointer, size_t count) { (void)pointer; (void)count; }
+
+    FrameArena* GetArena() const { return mArena; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return mArena == other.GetArena(); }
+
+private:
+    FrameArena* mArena;
+};
+
+// Type Alias
+//------------------------------------------------------------------------------
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
\ No newline at end of file
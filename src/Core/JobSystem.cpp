@@ -0,0 +1,261 @@
+#include "Core/JobSystem.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <cassert>
+
+//------------------------------------------------------------------------------
+// Position of the current thread in the job system it belongs to, unregistered threads outside of every pool use 0
+static thread_local const JobSystem* tJobSystem = nullptr;
+static thread_local uint32_t tThreadIndex = 0;
+
+//------------------------------------------------------------------------------
+static constexpr size_t kScratchArenaCapacity = 256 * 1024;
+
+//------------------------------------------------------------------------------
+JobSystem::JobSystem(uint32_t workerCount)
+    : mWorkerCount(workerCount)
+    , mQueuedJobs(0)
+    , mShutdown(false)
+{
+    for (std::atomic<bool>& slot : mRegisteredSlots)
+    {
+        slot.store(false);
+    }
+
+    for (uint32_t i = 0; i < 1 + workerCount + kMaxRegisteredThreads; i++)
+    {
+        mQueues.push_back(std::make_unique<JobQueue>());
+        mScratchArenas.push_back(std::make_unique<FrameArena>(kScratchArenaCapacity));
+    }
+
+    // Queues are created up front, workers steal from each other as soon as they start
+    for (uint32_t i = 1; i <= workerCount; i++)
+    {
+        mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+//------------------------------------------------------------------------------
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mShutdown = true;
+    }
+    mWakeCondition.notify_all();
+
+    for (std::thread& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+//------------------------------------------------------------------------------
+uint32_t JobSystem::DefaultWorkerCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency()) - 1;
+}
+
+//------------------------------------------------------------------------------
+void JobSystem::RegisterThread()
+{
+    assert(tJobSystem != this && "Error: Thread is already part of the job system!");
+
+    for (uint32_t slot = 0; slot < kMaxRegisteredThreads; slot++)
+    {
+        bool isTaken = false;
+        if (mRegisteredSlots[slot].compare_exchange_strong(isTaken, true))
+        {
+            tJobSystem = this;
+            tThreadIndex = 1 + mWorkerCount + slot;
+            return;
+        }
+    }
+
+    assert(false && "Error: Too many threads registered with the job system!");
+}
+
+//------------------------------------------------------------------------------
+void JobSystem::UnregisterThread()
+{
+    assert(tJobSystem == this && tThreadIndex > mWorkerCount && "Error: Thread is not registered with the job system!");
+
+    mScratchArenas[tThreadIndex]->Reset();
+    mRegisteredSlots[tThreadIndex - 1 - mWorkerCount].store(false);
+    tJobSystem = nullptr;
+    tThreadIndex = 0;
+}
+
+//------------------------------------------------------------------------------
+void JobSystem::Wait(const JobCounter& counter)
+{
+    const uint32_t threadIndex = GetThreadIndex();
+
+    while (!counter.IsDone())
+    {
+        Job job;
+        if (TryPop(threadIndex, job))
+        {
+            Execute(job);
+        }
+        else
+        {
+            // The remaining jobs are running on other threads
+            std::this_thread::yield();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+FrameArena& JobSystem::GetScratchArena()
+{
+    return *mScratchArenas[GetThreadIndex()];
+}
+
+//------------------------------------------------------------------------------
+void JobSystem::ResetScratchArenas()
+{
+    // Registered threads come last and keep their arenas
+    for (uint32_t i = 0; i <= mWorkerCount; i++)
+    {
+        mScratchArenas[i]->Reset();
+    }
+}
+
+//------------------------------------------------------------------------------
+void JobSystem::Push(const Job* jobs, size_t count, JobCounter& counter)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    counter.mPending.fetch_add(static_cast<uint32_t>(count), std::memory_order_relaxed);
+
+    JobQueue& queue = *mQueues[GetThreadIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mMutex);
+        queue.mJobs.insert(queue.mJobs.end(), jobs, jobs + count);
+        mQueuedJobs.fetch_add(count);
+    }
+
+    // Taking the sleep mutex orders the push before a worker's check of mQueuedJobs, so no wake up is lost
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+    }
+
+    if (count == 1)
+    {
+        mWakeCondition.notify_one();
+    }
+    else
+    {
+        mWakeCondition.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool JobSystem::TryPop(uint32_t threadIndex, Job& outJob)
+{
+    if (TryPopBack(*mQueues[threadIndex], outJob))
+    {
+        return true;
+    }
+
+    // Steal from the other queues, starting with the next thread to spread the thieves out. Threads outside of
+    // the pool only steal from workers, a render thread waiting on its frame never picks up a loader's jobs.
+    const size_t queueCount = mQueues.size();
+    const bool isWorker = IsWorker(threadIndex);
+    for (size_t offset = 1; offset < queueCount; offset++)
+    {
+        const uint32_t victim = static_cast<uint32_t>((threadIndex + offset) % queueCount);
+        if ((isWorker || IsWorker(victim)) && TrySteal(*mQueues[victim], outJob))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool JobSystem::TryPopBack(JobQueue& queue, Job& outJob)
+{
+    std::lock_guard<std::mutex> lock(queue.mMutex);
+    if (queue.mFront == queue.mJobs.size())
+    {
+        return false;
+    }
+
+    outJob = queue.mJobs.back();
+    queue.mJobs.pop_back();
+    if (queue.mFront == queue.mJobs.size())
+    {
+        queue.mJobs.clear();
+        queue.mFront = 0;
+    }
+
+    mQueuedJobs.fetch_sub(1);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool JobSystem::TrySteal(JobQueue& queue, Job& outJob)
+{
+    std::lock_guard<std::mutex> lock(queue.mMutex);
+    if (queue.mFront == queue.mJobs.size())
+    {
+        return false;
+    }
+
+    outJob = queue.mJobs[queue.mFront++];
+    if (queue.mFront == queue.mJobs.size())
+    {
+        queue.mJobs.clear();
+        queue.mFront = 0;
+    }
+
+    mQueuedJobs.fetch_sub(1);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void JobSystem::Execute(const Job& job)
+{
+    job.mFunc(job.mTask, job.mBegin, job.mEnd);
+
+    // Release the job's writes to the thread that sees the counter reach zero
+    job.mCounter->mPending.fetch_sub(1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+uint32_t JobSystem::GetThreadIndex() const
+{
+    return tJobSystem == this ? tThreadIndex : 0;
+}
+
+//------------------------------------------------------------------------------
+void JobSystem::WorkerLoop(uint32_t threadIndex)
+{
+    tJobSystem = this;
+    tThreadIndex = threadIndex;
+
+    while (true)
+    {
+        Job job;
+        if (TryPop(threadIndex, job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeCondition.wait(lock, [this] { return mShutdown || mQueuedJobs.load() > 0; });
+        if (mShutdown)
+        {
+            return;
+        }
+    }
+}
\ No newline at end of file
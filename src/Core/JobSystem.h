@@ -0,0 +1,160 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// Core
+#include "Core/FrameArena.h"
+
+// System
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+    Tracks a group of queued jobs. Every job increments the counter when it is queued and
+    decrements it once it has run, so the group is done when the counter is back at zero.
+    A counter must outlive the jobs it tracks.
+*/
+//------------------------------------------------------------------------------
+class JobCounter
+{
+public:
+    bool IsDone() const { return mPending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> mPending = 0;
+};
+
+/*
+    Work-stealing task scheduler with a fixed pool of worker threads. Every thread owns a job
+    queue: it runs its own jobs newest first and, once that queue is empty, steals the oldest
+    jobs of the other threads. Threads that wait on a counter run queued jobs in the meantime,
+    so a job may wait on the counter of jobs it queued itself to express a dependency.
+
+    Jobs reference their task, they do not copy it. The task has to stay alive until the
+    counter of its jobs is done.
+
+    Threads outside of the pool that queue jobs, such as a loader thread, register to get a
+    queue and a scratch arena of their own. They steal only from workers, so their jobs and the
+    jobs of the creating thread never run inside each other's waits. Threads that do not register share those of the
+    thread that created the job system and must not use it at the same time as that thread.
+*/
+//------------------------------------------------------------------------------
+class JobSystem
+{
+public:
+    // The thread that waits on counters runs jobs too, so the default spawns one worker less than the core count
+    explicit JobSystem(uint32_t workerCount = DefaultWorkerCount());
+    ~JobSystem();
+
+    // Threads outside of the pool that can be registered at the same time
+    static constexpr uint32_t kMaxRegisteredThreads = 4;
+
+    // Gives the calling thread its own queue and scratch arena, unregister once its jobs are done
+    void RegisterThread();
+    void UnregisterThread();
+
+    // Queues task(index) for every index in [0, count), batchSize consecutive indices form one job
+    template<typename Task>
+    void ParallelFor(size_t count, size_t batchSize, Task& task, JobCounter& counter)
+    {
+        constexpr size_t kMaxBatchesPerPush = 64;
+        Job jobs[kMaxBatchesPerPush];
+
+        batchSize = std::max<size_t>(batchSize, 1);
+        for (size_t begin = 0; begin < count;)
+        {
+            size_t jobCount = 0;
+            for (; jobCount < kMaxBatchesPerPush && begin < count; jobCount++, begin += batchSize)
+            {
+                jobs[jobCount] = { &InvokeTaskRange<Task>, &task, begin, std::min(begin + batchSize, count), &counter };
+            }
+            Push(jobs, jobCount, counter);
+        }
+    }
+
+    // Runs task(index) for every index in [0, count) and returns once all of them are done
+    template<typename Task>
+    void ParallelFor(size_t count, size_t batchSize, Task&& task)
+    {
+        JobCounter counter;
+        ParallelFor(count, batchSize, task, counter);
+        Wait(counter);
+    }
+
+    // Runs queued jobs until the counter is done
+    void Wait(const JobCounter& counter);
+
+    // Scratch memory of the calling thread. The arenas of the pool and of the creating thread are reset
+    // together by ResetScratchArenas once per frame, so jobs that may run across that point must not use
+    // them. A registered thread resets its own arena.
+    FrameArena& GetScratchArena();
+    void ResetScratchArenas();  // Only call from the creating thread while none of its jobs are running
+
+    // Threads that run the jobs of a parallel for, the workers and the thread that waits
+    size_t GetThreadCount() const { return mWorkers.size() + 1; }
+
+    static uint32_t DefaultWorkerCount();
+
+    // Delete copy and assignment, worker threads hold a pointer to this instance
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+private:
+    struct Job
+    {
+        void (*mFunc)(void* task, size_t begin, size_t end) = nullptr;
+        void* mTask = nullptr;
+        size_t mBegin = 0;
+        size_t mEnd = 0;
+        JobCounter* mCounter = nullptr;
+    };
+
+    // Jobs are taken from the back by the owner and from the front by thieves. The storage is
+    // only cleared when the queue runs empty, so it keeps its capacity across frames.
+    struct alignas(64) JobQueue
+    {
+        std::mutex mMutex;
+        std::vector<Job> mJobs;
+        size_t mFront = 0;
+    };
+
+    template<typename Task>
+    static void InvokeTaskRange(void* task, size_t begin, size_t end)
+    {
+        for (size_t index = begin; index < end; index++)
+        {
+            (*static_cast<Task*>(task))(index);
+        }
+    }
+
+    void Push(const Job* jobs, size_t count, JobCounter& counter);
+    bool TryPop(uint32_t threadIndex, Job& outJob);
+    bool TryPopBack(JobQueue& queue, Job& outJob);
+    bool TrySteal(JobQueue& queue, Job& outJob);
+    void Execute(const Job& job);
+    uint32_t GetThreadIndex() const;
+    bool IsWorker(uint32_t threadIndex) const { return threadIndex >= 1 && threadIndex <= mWorkerCount; }
+    void WorkerLoop(uint32_t threadIndex);
+
+    // Index 0 belongs to the thread that created the job system, workers follow, registered threads come last
+    std::vector<std::unique_ptr<JobQueue>> mQueues;
+    std::vector<std::unique_ptr<FrameArena>> mScratchArenas;
+    std::vector<std::thread> mWorkers;
+    std::array<std::atomic<bool>, kMaxRegisteredThreads> mRegisteredSlots;
+    uint32_t mWorkerCount;
+
+    std::atomic<size_t> mQueuedJobs;
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeCondition;
+    bool mShutdown;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "Core/MappedFile.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+//------------------------------------------------------------------------------
+MappedFile::MappedFile(const fs::path& filepath)
+    : mData(nullptr)
+    , mSize(0)
+    , mValid(false)
+    , mFileHandle(INVALID_HANDLE_VALUE)
+    , mMappingHandle(nullptr)
+{
+    mFileHandle = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (mFileHandle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(mFileHandle, &fileSize))
+    {
+        return;
+    }
+
+    // Empty files cannot be mapped, they are valid with empty contents
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+    if (mSize == 0)
+    {
+        mValid = true;
+        return;
+    }
+
+    mMappingHandle = CreateFileMappingW(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mMappingHandle == nullptr)
+    {
+        return;
+    }
+
+    mData = MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+    mValid = mData != nullptr;
+}
+
+//------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+    }
+
+    if (mMappingHandle != nullptr)
+    {
+        CloseHandle(mMappingHandle);
+    }
+
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFileHandle);
+    }
+}
+#else
+//------------------------------------------------------------------------------
+MappedFile::MappedFile(const fs::path& filepath)
+    : mData(nullptr)
+    , mSize(0)
+    , mValid(false)
+{
+    const int fileDescriptor = open(filepath.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) == 0)
+    {
+        // Empty files cannot be mapped, they are valid with empty contents
+        mSize = static_cast<size_t>(fileStatus.st_size);
+        if (mSize == 0)
+        {
+            mValid = true;
+        }
+        else
+        {
+            void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, mSize, MADV_WILLNEED);
+                mData = data;
+                mValid = true;
+            }
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fileDescriptor);
+}
+
+//------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+    if (mData != nullptr)
+    {
+        munmap(const_cast<void*>(mData), mSize);
+    }
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// Type Alias
+//------------------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+/*
+    Read-only memory mapping of a whole file. The operating system pages the contents in on
+    demand, so large files are parsed in place without being copied into a buffer first.
+*/
+//------------------------------------------------------------------------------
+class MappedFile
+{
+public:
+    explicit MappedFile(const fs::path& filepath);
+    ~MappedFile();
+
+    bool IsValid() const { return mValid; }
+    std::string_view GetContents() const { return { static_cast<const char*>(mData), mSize }; }
+
+    // Delete copy and assignment, the mapping is released in the destructor
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+    const void* mData;
+    size_t mSize;
+    bool mValid;
+
+#if defined(_WIN32)
+    void* mFileHandle;
+    void* mMappingHandle;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+//------------------------------------------------------------------------------
+enum class IndexFormat : uint8_t
+{
+    UInt16,
+    UInt32
+};
+
+/*
+    Triangle list indices into the unified vertex arrays of a mesh. Meshes with at most 65536
+    vertices store 16-bit indices, which halves the buffer. Like VertexStream, an index buffer
+    either owns its storage or views read-only storage owned elsewhere.
+*/
+//------------------------------------------------------------------------------
+class IndexBuffer
+{
+public:
+    static IndexFormat SelectFormat(size_t vertexCount) { return vertexCount <= 0x10000 ? IndexFormat::UInt16 : IndexFormat::UInt32; }
+    static size_t GetIndexSize(IndexFormat format) { return format == IndexFormat::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+    IndexBuffer() = default;
+    IndexBuffer(IndexBuffer&&) = default;
+    IndexBuffer& operator=(IndexBuffer&&) = default;
+
+    // Delete copy and assignment, the data pointer would still point into the source
+    IndexBuffer(const IndexBuffer&) = delete;
+    IndexBuffer& operator=(const IndexBuffer&) = delete;
+
+    // Copies the indices in the smallest format that addresses vertexCount vertices
+    void Assign(std::span<const uint32_t> indices, size_t vertexCount)
+    {
+        mFormat = SelectFormat(vertexCount);
+        mCount = indices.size();
+        mStorage.resize(mCount * GetIndexSize(mFormat));
+
+        if (mFormat == IndexFormat::UInt16)
+        {
+            uint16_t* data = reinterpret_cast<uint16_t*>(mStorage.data());
+            for (size_t i = 0; i < mCount; i++)
+            {
+                data[i] = static_cast<uint16_t>(indices[i]);
+            }
+        }
+        else
+        {
+            std::memcpy(mStorage.data(), indices.data(), indices.size_bytes());
+        }
+
+        mData = mStorage.data();
+    }
+
+    // Views count indices of the given format, data must stay alive and aligned to the index size
+    void View(const void* data, size_t count, IndexFormat format)
+    {
+        mStorage.clear();
+        mData = static_cast<const std::byte*>(data);
+        mCount = count;
+        mFormat = format;
+    }
+
+    size_t GetSize() const { return mCount; }
+    size_t GetSizeInBytes() const { return mCount * GetIndexSize(mFormat); }
+    IndexFormat GetFormat() const { return mFormat; }
+    const void* GetData() const { return mData; }
+
+    uint32_t Get(size_t index) const
+    {
+        assert(index < mCount && "Error: Index out of range!");
+        return mFormat == IndexFormat::UInt16 ? reinterpret_cast<const uint16_t*>(mData)[index] : reinterpret_cast<const uint32_t*>(mData)[index];
+    }
+
+private:
+    std::vector<std::byte> mStorage;
+    const std::byte* mData = nullptr;
+    size_t mCount = 0;
+    IndexFormat mFormat = IndexFormat::UInt32;
+};
\ No newline at end of file
@@ -13,10 +13,12 @@ public:
 		: mDirection(glm::normalize(direction))
 	{ }
 
-	float CalculateLightIntensity(const glm::vec3& faceNormal)
+	float CalculateLightIntensity(const glm::vec3& faceNormal) const
 	{		
 		return -glm::dot(faceNormal, mDirection);
 	}
+
+	const glm::vec3& GetDirection() const { return mDirection; }
 	
 private:
 	glm::vec3 mDirection;
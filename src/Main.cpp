@@ -1,6 +1,7 @@
 // Includes
 //------------------------------------------------------------------------------
 // Application
+#include "AssetLoader.h"
 #include "Mesh.h"
 #include "Matrix.h"
 #include "Light.h"
@@ -8,11 +9,16 @@
 #include "Clipping.h"
 #include "ColorBuffer.h"
 #include "GeometryRenderer.h"
+#include "RenderState.h"
 #include "TriangleRasterizer.h"
+#include "TileRasterizer.h"
+#include "VertexProcessing.h"
 #include "ZBuffer.h"
 
 // Core
 #include "Core/AppCore.h"
+#include "Core/Angle.h"
+#include "Core/FrameArena.h"
 #include "Core/Utils.h"
 #include "Core/SDLWrappers/SDLTexture.h"
 
@@ -20,12 +26,11 @@
 #include <SDL.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
-#include <fpm/fixed.hpp>
-#include <fpm/math.hpp> 
 
 // System
-#include <functional>
+#include <algorithm>
 #include <chrono>
+#include <span>
 
 /*
     TODO:
@@ -37,10 +42,6 @@
     Pressing d we should disable the back-face culling
 */
 
-// Type Alias
-//------------------------------------------------------------------------------
-using RasterTriangleFunc = std::function<void(const glm::ivec2& point, const std::array<Vertex, 3>& vertices)>;
-
 //------------------------------------------------------------------------------
 enum class CullMethod
 {
@@ -75,470 +76,19 @@ public:
     float mYawAngle;
 };
 
-
-//------------------------------------------------------------------------------
-class FixedPointVector
-{
-public:
-    static constexpr int32_t kShift = 4;
-    static constexpr int32_t kMultiplier = 1 << kShift;
-	static constexpr int32_t kOne = 1 << kShift;
-    static constexpr int32_t kHalf = kOne >> kShift;
-
-	FixedPointVector()
-		: mX(0)
-		, mY(0)
-        , mZ(0)
-        , mW(kOne)
-	{ }
-
-	template<typename T>
-	FixedPointVector(T x, T y, T z)
-	{
-		mX = static_cast<int32_t>(std::round(x) * kMultiplier);
-        mY = static_cast<int32_t>(std::round(y) * kMultiplier);
-        mZ = static_cast<int32_t>(std::round(z) * kMultiplier);
-		mW = kOne;
-    }
-
-    template<typename T>
-    FixedPointVector(T x, T y, T z, T w)
-    { 
-		mX = static_cast<int32_t>(std::round(x) * kMultiplier);
-        mY = static_cast<int32_t>(std::round(y) * kMultiplier);
-        mZ = static_cast<int32_t>(std::round(z) * kMultiplier);
-        mW = static_cast<int32_t>(std::round(w) * kMultiplier);
-    }
-
-    FixedPointVector operator-(const FixedPointVector& other) const 
-    {
-        int32_t xComponent = (mX - other.mX) >> kShift;
-        int32_t yComponent = (mY - other.mY) >> kShift;
-        int32_t zComponent = (mZ - other.mZ) >> kShift;
-
-        return { xComponent, yComponent, zComponent };        
-    }
-
-    FixedPointVector operator+(const FixedPointVector& other) const
-    {
-		int32_t xComponent = (mX + other.mX) >> kShift;
-		int32_t yComponent = (mY + other.mY) >> kShift;
-		int32_t zComponent = (mZ + other.mZ) >> kShift;
-
-        return { xComponent, yComponent, zComponent };
-    }
-
-	int32_t mX;
-	int32_t mY;
-    int32_t mZ;
-    int32_t mW;
-};
-
 //------------------------------------------------------------------------------
-class SimpleRendererApplication : public Application
+struct LineSegment
 {
-	using FixedPoint = fpm::fixed_16_16;
-
-public:
-    SimpleRendererApplication(const AppConfig& config)
-        : Application(config)
-        , mColorBuffer(GetContext(), { 128, 128 })
-    { }
-
-    virtual void OnEvent(const SDL_Event& event, float timeslice)
-    {
-        (void)timeslice; // Unused
-
-        if (event.type == SDL_KEYDOWN)
-        {
-            if (event.key.keysym.sym == SDLK_1)
-            {
-                mDrawTriangle0 = !mDrawTriangle0;
-            }
-            else if (event.key.keysym.sym == SDLK_2)
-            {
-                mDrawTriangle1 = !mDrawTriangle1;
-			}
-			else if (event.key.keysym.sym == SDLK_3)
-			{
-				mEnableFillRule = !mEnableFillRule;
-				std::cout << "Fill rule: " << (mEnableFillRule ? "ON" : "OFF") << std::endl;
-			}
-			else if (event.key.keysym.sym == SDLK_UP)
-			{
-				mAngle += 0.1f;
-			}
-			else if (event.key.keysym.sym == SDLK_DOWN)
-			{
-				mAngle -= 0.1f;
-			}
-        }
-    }
-
-    virtual void OnRender() override
-    {        
-        static std::vector<glm::vec2> vertices = {
-            { 40, 40 },
-            { 80, 40 },
-            { 40, 80 },
-            { 90, 90 }
-        };
-
-        static std::vector<glm::vec4> colors = {
-            {0xff, 0x00, 0x00, 0xff },
-            {0x00, 0xff, 0x00, 0xff },
-            {0x00, 0x00, 0xff, 0xff }
-        };
-
-        //float angle = static_cast<float>(SDL_GetTicks() / 1000.0f * 0.1f);
-        glm::vec2 center = { 60, 60 };
-
-        glm::vec2 v0 = Rotate(vertices[0], center, mAngle);
-        glm::vec2 v1 = Rotate(vertices[1], center, mAngle);
-        glm::vec2 v2 = Rotate(vertices[2], center, mAngle);
-        glm::vec2 v3 = Rotate(vertices[3], center, mAngle);
-
-        mColorBuffer.Clear(0x00000000);
-        if (mDrawTriangle0)
-        {
-            DrawTexturedTriangleV1(
-                { v0, v1, v2 },
-                0xffffffff
-            );
-
-            //DrawTexturedTriangle(
-            //    { v0, v1, v2 },
-            //    0xfff00fff
-            //);
-        }
-        //if (mDrawTriangle1)
-        //{
-        //    DrawTexturedTriangleV1(
-        //        { v3, v2, v1 },
-        //        0xff0000ff
-        //    );
-        //    DrawTexturedTriangle(
-        //        { v0, v1, v2 },
-        //        0xffffffff
-        //    )
-        //}
-        mColorBuffer.Render();
-        
-    }
-
-private:
-    //------------------------------------------------------------------------------
-    void DrawTexturedTriangle(const std::array<glm::vec2, 3>& vertices, int32_t color)
-    {
-        // Vertex positions (integer screen coordinates)
-        glm::ivec2 p0 = vertices[0];
-        glm::ivec2 p1 = vertices[1];
-        glm::ivec2 p2 = vertices[2];
-
-        // Compute bounding box
-        int32_t xMin = std::min({ p0.x, p1.x, p2.x });
-        int32_t yMin = std::min({ p0.y, p1.y, p2.y });
-        int32_t xMax = std::max({ p0.x, p1.x, p2.x });
-        int32_t yMax = std::max({ p0.y, p1.y, p2.y });        
-
-        // Loop over the bounding box (rasterization)
-        for (int32_t y = yMin; y < yMax; y++)
-        {
-            for (int32_t x = xMin; x < xMax; x++)
-            {
-				float e0 = GetDeterminant(p1, p2, { x, y });
-				float e1 = GetDeterminant(p2, p0, { x, y });
-				float e2 = GetDeterminant(p0, p1, { x, y });
-
-                // Check if the pixel is inside the triangle
-                if (e0 >= 0 && e1 >= 0 && e2 >= 0)
-                {
-					mColorBuffer.SetPixel(x, y, color);                                        
-                }                
-            }            
-        }
-    }
-
-    //------------------------------------------------------------------------------
-    void DrawTexturedTriangleV1(const std::array<glm::vec2, 3>& vertices, int32_t color)
-    {
-        // Vertex positions (integer screen coordinates)
-		FixedPointVector p0 { vertices[0].x, vertices[0].y, 0.0f };
-        FixedPointVector p1 { vertices[1].x, vertices[1].y, 0.0f };
-        FixedPointVector p2 { vertices[2].x, vertices[2].y, 0.0f };
-
-        // Compute bounding box
-        int32_t xMin = std::min({ p0.mX, p1.mX, p2.mX }) >> FixedPointVector::kShift;
-        int32_t yMin = std::min({ p0.mY, p1.mY, p2.mY }) >> FixedPointVector::kShift;
-
-        int32_t xMax = std::max({ p0.mX, p1.mX, p2.mX }) >> FixedPointVector::kShift;
-        int32_t yMax = std::max({ p0.mY, p1.mY, p2.mY }) >> FixedPointVector::kShift;
-
-        // Precompute edge function step deltas for rasterization
-        int32_t deltaEdge0X = (p1.mY - p2.mY) << FixedPointVector::kShift;
-        int32_t deltaEdge1X = (p2.mY - p0.mY) << FixedPointVector::kShift;
-        int32_t deltaEdge2X = (p0.mY - p1.mY) << FixedPointVector::kShift;
-
-        int32_t deltaEdge0Y = (p2.mX - p1.mX) << FixedPointVector::kShift;
-        int32_t deltaEdge1Y = (p0.mX - p2.mX) << FixedPointVector::kShift;
-        int32_t deltaEdge2Y = (p1.mX - p0.mX) << FixedPointVector::kShift;
-
-        // Compute edge function values for the top-left pixel
-        FixedPointVector topLeftPixel { xMin, yMin, 0 };
-        int32_t edge0 = GetDeterminant(p1, p2, topLeftPixel);
-        int32_t edge1 = GetDeterminant(p2, p0, topLeftPixel);
-        int32_t edge2 = GetDeterminant(p0, p1, topLeftPixel);
-
-        // Loop over the bounding box (rasterization)
-        for (int32_t y = yMin; y < yMax; y++)
-        {
-            int32_t e0 = edge0;
-            int32_t e1 = edge1;
-            int32_t e2 = edge2;
-
-            for (int32_t x = xMin; x < xMax; x++)
-            {
-                // Check if the pixel is inside the triangle
-                if (e0 >= 0 && e1 >= 0 && e2 >= 0)
-                {
-                    mColorBuffer.SetPixel(x, y, color);
-                }
-
-                // Step edge functions in X direction
-                e0 += deltaEdge0X;
-                e1 += deltaEdge1X;
-                e2 += deltaEdge2X;
-            }
-
-            // Step edge functions in Y direction
-            edge0 += deltaEdge0Y;
-            edge1 += deltaEdge1Y;
-            edge2 += deltaEdge2Y;
-        }
-    }
-
-    float GetDeterminant(const glm::vec2& a, const glm::vec2& b, const glm::vec2 c)
-    {		
-		glm::vec2 ab = b - a;
-		glm::vec2 ac = c - a;
-
-		return ab.x * ac.y - ab.y * ac.x;        
-    }
-
-    int32_t GetDeterminant(const FixedPointVector& a, const FixedPointVector& b, const FixedPointVector& c)
-    {
-        FixedPointVector ab = b - a;
-        FixedPointVector ac = c - a;
-
-        return ab.mX * ac.mY - ab.mY * ac.mX;        
-    }
-
-    glm::vec4 Rotate(glm::vec2 v, glm::vec2 center, float angle)
-    {
-        glm::vec4 rot;
-        v.x -= center.x;
-        v.y -= center.y;
-        rot.x = v.x * cos(angle) - v.y * sin(angle);
-        rot.y = v.x * sin(angle) + v.y * cos(angle);
-        rot.x += center.x;
-        rot.y += center.y;
-
-        return rot;
-    }
-
-    /*
-    float EdgeCrossProduct(const glm::vec2& a, const glm::vec2& b, const glm::vec2 point)
-    {
-        return (b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x);
-    }
-
-    fpm::fixed_16_16 GetDeterminant(const FixedPointVector& a, const FixedPointVector& b, const FixedPointVector& c)
-    {
-		FixedPointVector ab = b - a;
-		FixedPointVector ac = c - a;
-
-        return ab.GetX() * ac.GetY() - ab.GetY() * ac.GetX();
-    }
-
-    bool IsLeftOrTopEdge(const FixedPointVector& start, const FixedPointVector& end)
-    {
-        const FixedPointVector edge = end - start;
-        const FixedPoint zero { 0 };
-
-        const bool isTopEdge = (edge.GetY() == zero) && (edge.GetX() > zero);
-        const bool isLeftEdge = (edge.GetY() < zero);
-
-        return (isTopEdge || isLeftEdge);
-    }
-
-    void DrawTexturedTriangle1(const std::array<glm::vec2, 3>& vertices, uint32_t color)
-    {
-		// Constants
-        const FixedPoint zero { 0.0f };
-        const FixedPoint half { 0.5f };
-        const FixedPoint leastPreciseUnit { 1.0f / (1 << 8) };
-
-        // Vertex positions (integer screen coordinates)
-        glm::vec2 p0 = vertices[0];
-        glm::vec2 p1 = vertices[1];
-        glm::vec2 p2 = vertices[2];
-
-        const FixedPointVector vec0 { p0.x, p0.y };
-        const FixedPointVector vec1 { p1.x, p1.y };
-        const FixedPointVector vec2 { p2.x, p2.y };
-
-        // Create bounding box around triangle
-        const FixedPoint xMin { std::floor(std::min({ p0.x, p1.x, p2.x })) };
-        const FixedPoint yMin { std::floor(std::min({ p0.y, p1.y, p2.y })) };
-
-        const FixedPoint xMax { std::ceil(std::max({ p0.x, p1.x, p2.x })) };
-        const FixedPoint yMax { std::ceil(std::max({ p0.y, p1.y, p2.y })) };
-
-        // Precompute edge function step deltas for rasterization
-        FixedPoint deltaEdge0X { vec1.GetY() - vec2.GetY() };
-        FixedPoint deltaEdge1X { vec2.GetY() - vec0.GetY() };
-        FixedPoint deltaEdge2X { vec0.GetY() - vec1.GetY() };
-        FixedPoint deltaEdge0Y { vec2.GetX() - vec1.GetX() };
-        FixedPoint deltaEdge1Y { vec0.GetX() - vec2.GetX() };
-        FixedPoint deltaEdge2Y { vec1.GetX() - vec0.GetX() };
-        
-        // Rasterization fill convention (top-left rule)
-        FixedPoint bias0 = IsLeftOrTopEdge(vec1, vec2) ? zero : -leastPreciseUnit;
-        FixedPoint bias1 = IsLeftOrTopEdge(vec2, vec0) ? zero : -leastPreciseUnit;
-        FixedPoint bias2 = IsLeftOrTopEdge(vec0, vec1) ? zero : -leastPreciseUnit;
-
-        // Compute edge function values for the top-left pixel
-        FixedPointVector topLeftPixel { xMin + half, yMin + half };
-        FixedPoint edge0 = GetDeterminant(vec1, vec2, topLeftPixel);
-        FixedPoint edge1 = GetDeterminant(vec2, vec0, topLeftPixel);
-        FixedPoint edge2 = GetDeterminant(vec0, vec1, topLeftPixel);
-
-        if (mEnableFillRule)
-        {
-            edge0 += bias0;
-            edge1 += bias1;
-            edge2 += bias2;
-        }
-
-        for (FixedPoint y = yMin; y <= yMax; y += 1)
-        {
-            FixedPoint e0 { edge0 };
-            FixedPoint e1 { edge1 };
-            FixedPoint e2 { edge2 };
-
-            for (FixedPoint x = xMin; x <= xMax; x += 1)
-            {
-                // Check if the pixel is inside the triangle
-                if (e0 >= zero && e1 >= zero && e2 >= zero)
-                {
-                    mColorBuffer.SetPixel(static_cast<int32_t>(x), static_cast<int32_t>(y), color);
-
-					if (e0 - leastPreciseUnit < zero && bias0 == zero)
-					{
-						mColorBuffer.SetPixel(static_cast<int32_t>(x), static_cast<int32_t>(y), 0xff00ffff);
-					}
-                    if (e1 - leastPreciseUnit < zero && bias1 == zero)
-                    {
-                        mColorBuffer.SetPixel(static_cast<int32_t>(x), static_cast<int32_t>(y), 0xff00ffff);
-                    }
-                    if (e2 - leastPreciseUnit < zero && bias2 == zero)
-                    {
-                        mColorBuffer.SetPixel(static_cast<int32_t>(x), static_cast<int32_t>(y), 0xff00ffff);
-                    }
-                }
-
-                // Step edge functions in X direction
-                e0 += deltaEdge0X;
-                e1 += deltaEdge1X;
-                e2 += deltaEdge2X;
-            }
-
-            // Step edge functions in Y direction
-            edge0 += deltaEdge0Y;
-            edge1 += deltaEdge1Y;
-            edge2 += deltaEdge2Y;
-        }
-    }
-
-    void DrawTexturedTriangle2(const std::array<glm::vec2, 3>& vertices, uint32_t color)
-    {
-        // Vertex positions (integer screen coordinates)
-        glm::ivec2 p0 = vertices[0];
-        glm::ivec2 p1 = vertices[1];
-        glm::ivec2 p2 = vertices[2];        
-
-        // Compute bounding box
-        int32_t xMin = std::min({ p0.x, p1.x, p2.x });
-        int32_t yMin = std::min({ p0.y, p1.y, p2.y });
-        int32_t xMax = std::max({ p0.x, p1.x, p2.x });
-        int32_t yMax = std::max({ p0.y, p1.y, p2.y });
-
-        // Precompute edge function step deltas for rasterization
-        int32_t deltaEdge0X = (p1.y - p2.y);
-        int32_t deltaEdge1X = (p2.y - p0.y);
-        int32_t deltaEdge2X = (p0.y - p1.y);
-        int32_t deltaEdge0Y = (p2.x - p1.x);
-        int32_t deltaEdge1Y = (p0.x - p2.x);
-        int32_t deltaEdge2Y = (p1.x - p0.x);
-
-        // Compute edge function values for the top-left pixel
-        glm::ivec2 topLeftPixel = { xMin, yMin };
-        int32_t edge0 = static_cast<int32_t>(EdgeCrossProduct(p1, p2, topLeftPixel));
-        int32_t edge1 = static_cast<int32_t>(EdgeCrossProduct(p2, p0, topLeftPixel));
-        int32_t edge2 = static_cast<int32_t>(EdgeCrossProduct(p0, p1, topLeftPixel));
-
-        // Loop over the bounding box (rasterization)
-        for (int32_t y = yMin; y < yMax; y++)
-        {
-            int32_t e0 = edge0;
-            int32_t e1 = edge1;
-            int32_t e2 = edge2;
-
-            for (int32_t x = xMin; x < xMax; x++)
-            {
-                // Check if the pixel is inside the triangle
-                if (e0 >= 0 && e1 >= 0 && e2 >= 0)
-                {
-                    mColorBuffer.SetPixel(x, y, color);
-                }
-
-                // Step edge functions in X direction
-                e0 += deltaEdge0X;
-                e1 += deltaEdge1X;
-                e2 += deltaEdge2X;
-            }
-
-            // Step edge functions in Y direction
-            edge0 += deltaEdge0Y;
-            edge1 += deltaEdge1Y;
-            edge2 += deltaEdge2Y;
-        }
-    }
-
-
-
-    bool IsFlatTopOrLeftEdge(const glm::ivec2& start, const glm::ivec2& end)
-    {
-        glm::ivec2 edge = end - start;
-        bool isFlatTopEdge = (edge.y == 0 && edge.x > 0);
-        bool isLeftEdge = (edge.y < 0);
-
-        return isFlatTopEdge || isLeftEdge;
-    }
-    */
-
-    ColorBuffer mColorBuffer;	
-    float mAngle = 0.0f;
-    bool mDrawTriangle0 = true;
-    bool mDrawTriangle1 = true;
-    bool mEnableFillRule = true;
+	glm::ivec2 mStart;
+	glm::ivec2 mEnd;
 };
 
 //------------------------------------------------------------------------------
-struct LineSegment
+// Output of one geometry job, it lives in the scratch arena of the thread that ran the job until the next frame
+struct GeometryChunk
 {
-	glm::ivec2 mStart;
-	glm::ivec2 mEnd;
+	std::span<const Triangle> mTriangles;
+	std::span<const LineSegment> mLineSegments;
 };
 
 //------------------------------------------------------------------------------
@@ -552,28 +102,35 @@ struct Transform
 //------------------------------------------------------------------------------
 class RendererApplication : public Application
 {
-    using FixedPoint = fpm::fixed_16_16;
-
 public:
+    static constexpr size_t kFacesPerGeometryChunk = 1024;
+
 	RendererApplication(const AppConfig& config)
 		: Application(config)
+		, mTrianglesToRender(mFrameArena)
 		, mDirectionalLight({ 0.0f, -1.0f, 1.0f })
-		, mZBuffer(GetContext())
 		, mColorBuffer(GetContext(), GetContext().GetWindowSize())
+		, mZBuffer(GetContext())
+		, mTileRasterizer(GetContext().GetWindowSize(), GetContext().mJobSystem)
+		, mLineSegments(mFrameArena)
+		, mAssetLoader(GetContext().mJobSystem)
 	{ }
 
     virtual void OnCreate() override
     {
-        mMesh = CreateMeshFromOBJFile(ResolveAssetPath("drone.obj"));
-		mTrianglesToRender.reserve(mMesh->FaceCount());
-		mTexture = std::make_unique<Texture>(ResolveAssetPath("cube.png"));
+        // Draw the placeholders until the streamed assets arrive
+        mPlaceholderMesh = CreatePlaceholderMesh();
+        mPlaceholderTexture = CreatePlaceholderTexture();
+        mMesh = mPlaceholderMesh.get();
+        mTexture = mPlaceholderTexture.get();
+
+        mMeshRequest = mAssetLoader.RequestMesh(ResolveAssetPath("drone.obj"));
+        mTextureRequest = mAssetLoader.RequestTexture(ResolveAssetPath("cube.png"), TextureLayout::Tiled);
 
         const glm::vec2 windowSize = glm::vec2(GetContext().GetWindowSize());
 
 		const float aspectY = windowSize.y / windowSize.x;
-        const float aspectX = windowSize.x / windowSize.y;
 		const Angle fovY = Angle::Degrees(60.0f);
-		const Angle fovX = Angle::Radians(2.0f * glm::atan(glm::tan(fovY.AsRadians() * 0.5f) * aspectX));
         const float near = 0.2f;
 		const float far = 110.0f;
 
@@ -584,7 +141,8 @@ public:
             far
         );
 
-		mClippingPlanes = ComputePerspectiveFrustrumPlanes(fovX, fovY, near, far);
+        // Side planes only clip against the range the rasterizer accepts, it scissors to the viewport
+        mClipGuardBand = ComputeClipGuardBand(windowSize, kMaxScreenCoordinate);
     }
 
     virtual void OnEvent(const SDL_Event& event, float timeslice) override
@@ -617,14 +175,52 @@ public:
                 mCamera.mFowardVelocity = mCamera.mDirection * 5.0f * timeslice;
                 mCamera.mPosition -= mCamera.mFowardVelocity;
             }
+            else if (event.key.keysym.sym == SDLK_1)
+            {
+                // Wireframe
+                mRenderState.mPolygonMode = PolygonMode::Wireframe;
+            }
+            else if (event.key.keysym.sym == SDLK_2)
+            {
+                // Solid color, the triangle colors are already lit in OnUpdate
+                mRenderState.mPolygonMode = PolygonMode::Fill;
+                mRenderState.mTextured = false;
+                mRenderState.mLighting = LightingMode::None;
+            }
+            else if (event.key.keysym.sym == SDLK_3)
+            {
+                // Textured
+                mRenderState.mPolygonMode = PolygonMode::Fill;
+                mRenderState.mTextured = true;
+                mRenderState.mLighting = LightingMode::Smooth;
+            }
+            else if (event.key.keysym.sym == SDLK_g)
+            {
+                mUseGuardBand = !mUseGuardBand;
+            }
             else if (event.key.keysym.sym == SDLK_f)
             {
-				mApplyFillRule = !mApplyFillRule;
-				std::cout << "Fill rule: " << (mApplyFillRule ? "ON" : "OFF") << std::endl;
+                SamplerState sampler = mTexture->GetSampler();
+                sampler.mFilter = sampler.mFilter == TextureFilter::Nearest ? TextureFilter::Bilinear : TextureFilter::Nearest;
+                mTexture->SetSampler(sampler);
             }
 		}
     }
 
+    // Streamed assets replace their placeholders on the first frame after they arrive
+    void ResolveStreamedAssets()
+    {
+        mMesh = mMeshRequest.GetOr(mPlaceholderMesh.get());
+
+        Texture* texture = mTextureRequest.GetOr(mPlaceholderTexture.get());
+        if (texture != mTexture)
+        {
+            // Keep the filter picked while the placeholder was shown
+            texture->SetSampler(mTexture->GetSampler());
+            mTexture = texture;
+        }
+    }
+
     std::vector<Triangle> TransformMeshToScreen(const Mesh& mesh, const Transform& transform, glm::mat4& view, const glm::vec2& windowSize)
     {
         std::vector<Triangle> trianglesToRender;
@@ -635,7 +231,7 @@ public:
         {            
             if (i != 4) { continue; }
 
-            Triangle triangle = FaceToTriangle(*mMesh, mMesh->GetFace(i));
+            Triangle triangle = FaceToTriangle(*mMesh, mMesh->GetTriangle(i));
 
             for (size_t j = 0; j < 3; j++)
             {
@@ -657,8 +253,13 @@ public:
         const glm::vec2 windowSize = glm::vec2(GetContext().GetWindowSize());
 
         mZBuffer.Clear();
-        mTrianglesToRender.clear();        
-		mLineSegments.clear();
+        ResolveStreamedAssets();
+
+        // The previous frame's transient geometry lives in the frame arena, drop it before the arena is reused
+        mTrianglesToRender = ArenaVector<Triangle>(mFrameArena);
+        mLineSegments = ArenaVector<LineSegment>(mFrameArena);
+        mFrameArena.Reset();
+        GetContext().mJobSystem.ResetScratchArenas();
 
 		static Transform transform;
 		//transform.mRotation.y += 1.0f;
@@ -676,112 +277,134 @@ public:
         glm::vec3 up { 0.0f, 1.0f, 0.0f };
         glm::mat4 viewMatrix = CreateLookAt(mCamera.mPosition, target, up);
 
-		// Pre-process normals for smooth shading
-		std::unordered_map<size_t, std::vector<Face>> sharedVertexFaces;
+        // Vertex stage, transform every unique mesh position once
+        const ClipGuardBand guardBand = mUseGuardBand ? mClipGuardBand : ClipGuardBand();
+        const glm::mat4 modelViewMatrix = viewMatrix * modelMatrix;
+        TransformVertices(modelViewMatrix, mProjectionMatrix, guardBand, mMesh->GetPositions(), mTransformedVertices);
+
+        // Vertex normals stay in model space, the light is moved there instead. Valid for rotations and uniform scales.
+        const DirectionalLight modelLight(glm::transpose(glm::mat3(modelViewMatrix)) * mDirectionalLight.GetDirection());
+
+        // Geometry stage, faces are culled, lit and clipped in fixed size chunks on the job system. Every
+        // chunk writes to its own lists, appending them in chunk order keeps the draw order of the mesh.
+        const size_t faceCount = mMesh->FaceCount();
+        const size_t chunkCount = (faceCount + kFacesPerGeometryChunk - 1) / kFacesPerGeometryChunk;
+        mGeometryChunks.resize(chunkCount);
 
-        /*
-        Transform newTransform = transform;
-		newTransform.mScale *= 1.5f;
-		mWireframeTrianglesToRender = TransformMeshToScreen(*mMesh, newTransform, viewMatrix, windowSize);
-        
-        for (size_t i = 0; i < mMesh->FaceCount(); i++)
+        GetContext().mJobSystem.ParallelFor(chunkCount, 1, [&](size_t chunkIndex)
         {
-			const Face& face = mMesh->GetFace(i);
+            const size_t faceBegin = chunkIndex * kFacesPerGeometryChunk;
+            const size_t faceEnd = std::min(faceBegin + kFacesPerGeometryChunk, faceCount);
+            ProcessFaces(faceBegin, faceEnd, windowSize, guardBand, modelLight, mGeometryChunks[chunkIndex]);
+        });
+
+        size_t triangleCount = 0;
+        size_t lineSegmentCount = 0;
+        for (const GeometryChunk& chunk : mGeometryChunks)
+        {
+            triangleCount += chunk.mTriangles.size();
+            lineSegmentCount += chunk.mLineSegments.size();
+        }
 
-			for (size_t j = 0; j < 3; j++)
-			{
-                int32_t index = face.mVertexIndicies[j];
-				sharedVertexFaces[index].push_back(face);
-			}
-        }        
+        mTrianglesToRender.reserve(triangleCount);
+        mLineSegments.reserve(lineSegmentCount);
+        for (const GeometryChunk& chunk : mGeometryChunks)
+        {
+            mTrianglesToRender.insert(mTrianglesToRender.end(), chunk.mTriangles.begin(), chunk.mTriangles.end());
+            mLineSegments.insert(mLineSegments.end(), chunk.mLineSegments.begin(), chunk.mLineSegments.end());
+        }
+    }
+
+    // Culls, lights and clips the faces in [faceBegin, faceEnd), runs on the job system
+    void ProcessFaces(size_t faceBegin, size_t faceEnd, const glm::vec2& windowSize, const ClipGuardBand& guardBand, const DirectionalLight& modelLight,
+        GeometryChunk& outChunk)
+    {
+        // Scratch arenas keep their blocks across frames, after the first frames the chunks no longer allocate
+        FrameArena& scratchArena = GetContext().mJobSystem.GetScratchArena();
+        ArenaVector<Triangle> triangles(scratchArena);
+        ArenaVector<LineSegment> lineSegments(scratchArena);
+        triangles.reserve(faceEnd - faceBegin);
+        lineSegments.reserve(3 * (faceEnd - faceBegin));
 
-        for (const auto& [vertexIndex, faces] : sharedVertexFaces)
+        // Output of the clipper, declared once since value-initializing it per face would zero-fill every vertex
+        std::array<Triangle, kMaxClippedTriangles> clippedTriangles;
+
+        for (size_t i = faceBegin; i < faceEnd; i++)
         {
-            // Ensure each vertex index maps to at least one face
-            assert(!faces.empty() && "Error: Vertex index must be shared by at least one face!");
+            const std::array<uint32_t, 3> indices = mMesh->GetTriangle(i);
+            const std::array<ClipOutcodes, 3> outcodes = {
+                mTransformedVertices.mOutcodes[indices[0]],
+                mTransformedVertices.mOutcodes[indices[1]],
+                mTransformedVertices.mOutcodes[indices[2]]
+            };
+
+            // Trivial reject before the triangle is assembled, all vertices are outside of the same plane
+            if ((outcodes[0].mView & outcodes[1].mView & outcodes[2].mView) != 0)
+            {
+                continue;
+            }
 
-            std::cout << "Vertex Index: " << vertexIndex << " is shared by faces: ";
+            const std::array<glm::vec3, 3> viewPoints = {
+                mTransformedVertices.mViewPoints.Get(indices[0]),
+                mTransformedVertices.mViewPoints.Get(indices[1]),
+                mTransformedVertices.mViewPoints.Get(indices[2])
+            };
 
-            for (const Face& face : faces)
+            glm::vec3 faceNormal = ComputeFaceNormal(viewPoints[0], viewPoints[1], viewPoints[2]);
+
+            glm::ivec3 origin = { 0, 0, 0 };  // LookAt matrix tranforms the origin to the camera position
+            if (!IsTriangleFrontFaceVisibleToCamera(origin, faceNormal, viewPoints[0]))
             {
-                // Ensure that the vertex actually exists in the face
-                assert((face.mVertexIndicies[0] == vertexIndex ||
-                    face.mVertexIndicies[1] == vertexIndex ||
-                    face.mVertexIndicies[2] == vertexIndex) &&
-                    "Error: Face does not actually contain this vertex!");
-
-                std::cout << "(" << face.mVertexIndicies[0] << ", "
-                    << face.mVertexIndicies[1] << ", "
-                    << face.mVertexIndicies[2] << ") ";
+                continue;
             }
-            std::cout << std::endl;
-        }
-        */
 
-        // Build up a list of projected triangles to render
-        for (size_t i = 0; i < mMesh->FaceCount(); i++)
-        {            
-            //const Face& face = mMesh->GetFace(i);                        
-            Triangle triangle = FaceToTriangle(*mMesh, mMesh->GetFace(i));
-            
+            Triangle triangle = FaceToTriangle(*mMesh, indices, mTransformedVertices);
+
             for (size_t j = 0; j < 3; j++)
             {
-                Vertex& vertexData = triangle.mVertices[j];
-				vertexData.mPoint = viewMatrix * modelMatrix * vertexData.mPoint;
-				
-                /*
-				// Average the normals of the shared vertices for smooth shading
-				const size_t vertexIndex = face.mVertexIndicies[j];                
-                
-                glm::vec3 averagedNormal { };
-				for (const Face& sharedFace : sharedVertexFaces[vertexIndex])
-				{
-                    Triangle sharedTriangle = FaceToTriangle(*mMesh, sharedFace);
-                    averagedNormal += glm::normalize(ComputeFaceNormal(sharedTriangle));
-				}
-				averagedNormal = glm::normalize(averagedNormal);				
-                vertexData.mNormal = TransformNormal(modelMatrix, viewMatrix, averagedNormal);			                
-                */
+                const Vertex& vertex = triangle.mVertices[j];
+
+                glm::vec3 start = viewPoints[j];
+                glm::vec3 end = start + vertex.mNormal;
+
+                LineSegment lineSegment {
+                    TransformPointFromViewToScreen(windowSize, mProjectionMatrix, start),
+                    TransformPointFromViewToScreen(windowSize, mProjectionMatrix, end)
+                };
+                lineSegments.push_back(lineSegment);
             }
 
-            glm::vec3 faceNormal = ComputeFaceNormal(triangle);
+            // Apply directional lighting
+            float lightIntensity = mDirectionalLight.CalculateLightIntensity(faceNormal);
+            triangle.mColor = ApplyLightIntensity(triangle.mColor, lightIntensity);
 
-            glm::ivec3 origin = { 0, 0, 0 };  // LookAt matrix tranforms the origin to the camera position
-            if (!IsTriangleFrontFaceVisibleToCamera(origin, faceNormal, triangle))
+            // Smooth shading interpolates the intensities of the vertex normals, the other modes use the face
+            const bool smoothShading = mRenderState.mLighting == LightingMode::Smooth;
+            for (Vertex& vertex : triangle.mVertices)
             {
-                continue;
+                vertex.mIntensity = smoothShading ? modelLight.CalculateLightIntensity(vertex.mNormal) : lightIntensity;
             }
-            
-            // Clipping (enter with 1 triangle, exit with 0 or more triangles)        
-            for (Triangle& clippedTriangle : ClipWithFrustum(mClippingPlanes, triangle))            
-            {                
-                for (size_t j = 0; j < 3; j++)
+
+            // Clipping (enter with 1 triangle, exit with 0 or more triangles)
+            const size_t clippedCount = ClipTriangle(triangle, outcodes, clippedTriangles, guardBand);
+
+            for (size_t k = 0; k < clippedCount; k++)
+            {
+                Triangle& clippedTriangle = clippedTriangles[k];
+                for (Vertex& vertex : clippedTriangle.mVertices)
                 {
-                    Vertex& vertex = clippedTriangle.mVertices[j];                                                           
-                    
-                    glm::vec3 start = vertex.mPoint;
-                    glm::vec3 end = start + vertex.mNormal;
-
-                    LineSegment lineSegment {
-                        TransformPointFromViewToScreen(windowSize, mProjectionMatrix, start),
-                        TransformPointFromViewToScreen(windowSize, mProjectionMatrix, end)
-                    };
-					mLineSegments.push_back(lineSegment);					
-
-                    vertex.mPoint = TransformPointFromViewToScreen(windowSize, mProjectionMatrix, vertex.mPoint);                    
+                    vertex.mPoint = TransformPointFromClipToScreen(windowSize, vertex.mPoint);
                 }
 
-				// Apply directional lighting
-                float lightIntensity = mDirectionalLight.CalculateLightIntensity(faceNormal);
-                uint32_t shadedColor = ApplyLightIntensity(clippedTriangle.mColor, lightIntensity);
-                clippedTriangle.mColor = shadedColor;											
-
-                mTrianglesToRender.push_back(clippedTriangle);
+                triangles.push_back(clippedTriangle);
             }
         }
+
+        outChunk.mTriangles = std::span<const Triangle>(triangles.data(), triangles.size());
+        outChunk.mLineSegments = std::span<const LineSegment>(lineSegments.data(), lineSegments.size());
     }
 
-    Triangle FaceToTriangle(const Mesh& mesh, const Face& face)
+    Triangle FaceToTriangle(const Mesh& mesh, const std::array<uint32_t, 3>& indices)
     {
         Triangle triangle;
 
@@ -789,38 +412,39 @@ public:
         {
             Vertex& vertexData = triangle.mVertices[j];
             
-			vertexData.mPoint = glm::vec4(mesh.GetVertex(face.mVertexIndicies[j]), 1.0f);
-			vertexData.mUV = mesh.GetUV(face.mTextureIndicies[j]);
-            vertexData.mNormal = mesh.GetNormal(face.mNormalIndicies[j]);
+			vertexData.mPoint = glm::vec4(mesh.GetVertex(indices[j]), 1.0f);
+			vertexData.mUV = mesh.GetUV(indices[j]);
+            vertexData.mNormal = mesh.GetNormal(indices[j]);
         }
 
 		return triangle;
     }
 
+    // Assembles a clip-space triangle from the post-transform buffer
+    Triangle FaceToTriangle(const Mesh& mesh, const std::array<uint32_t, 3>& indices, const TransformedVertexStream& transformedVertices)
+    {
+        Triangle triangle;
+
+        for (size_t j = 0; j < 3; j++)
+        {
+            Vertex& vertexData = triangle.mVertices[j];
+
+            vertexData.mPoint = transformedVertices.mClipPoints.Get(indices[j]);
+            vertexData.mUV = mesh.GetUV(indices[j]);
+            vertexData.mNormal = mesh.GetNormal(indices[j]);
+        }
+
+        return triangle;
+    }
+
     virtual void OnRender() override
     {
 		mColorBuffer.Clear(0x00000000);
 
         auto start = std::chrono::high_resolution_clock::now();
-        for (Triangle& triangle : mTrianglesToRender)
-        {
-            const auto& vertices = triangle.mVertices;
-
-            DrawTexturedTriangle(
-				{ vertices[0].mPoint, vertices[1].mPoint, vertices[2].mPoint },
-				triangle.mColor
-			);
-
-            //DrawTexturedTriangle(mColorBuffer, mZBuffer,
-            //    { vertices[0].mPoint, vertices[1].mPoint, vertices[2].mPoint },
-            //    { vertices[0].mUV, vertices[1].mUV, vertices[2].mUV },
-            //    { 1.0f, 1.0f, 1.0f },
-            //    *mTexture);
-
-			//DrawWireframeTriangle(mColorBuffer,
-			//	{ vertices[0].mPoint, vertices[1].mPoint, vertices[2].mPoint },
-			//	0xFFFFFFFF);
-        }
+
+        // Bin triangles into screen tiles and rasterize the tiles in parallel
+        mTileRasterizer.DrawTriangles(mColorBuffer, mZBuffer, mRenderState, mTrianglesToRender, mTexture);
 
 		//for (Triangle& triangle : mWireframeTrianglesToRender)
 		//{
@@ -844,84 +468,6 @@ public:
     }
 
 private:    
-    void DrawTexturedTriangle(const std::array<glm::vec2, 3>& vertices, int32_t color)
-    {
-        // Vertex positions (integer screen coordinates)
-        FixedPointVector p0{ vertices[0].x, vertices[0].y, 0.0f };
-        FixedPointVector p1{ vertices[1].x, vertices[1].y, 0.0f };
-        FixedPointVector p2{ vertices[2].x, vertices[2].y, 0.0f };
-
-        // Compute bounding box
-        int32_t xMin = std::min({ p0.mX, p1.mX, p2.mX }) >> FixedPointVector::kShift;
-        int32_t yMin = std::min({ p0.mY, p1.mY, p2.mY }) >> FixedPointVector::kShift;
-
-        int32_t xMax = std::max({ p0.mX, p1.mX, p2.mX }) >> FixedPointVector::kShift;
-        int32_t yMax = std::max({ p0.mY, p1.mY, p2.mY }) >> FixedPointVector::kShift;
-
-        // Precompute edge function step deltas for rasterization
-        int32_t deltaEdge0X = (p1.mY - p2.mY) << FixedPointVector::kShift;
-        int32_t deltaEdge1X = (p2.mY - p0.mY) << FixedPointVector::kShift;
-        int32_t deltaEdge2X = (p0.mY - p1.mY) << FixedPointVector::kShift;
-        int32_t deltaEdge0Y = (p2.mX - p1.mX) << FixedPointVector::kShift;
-        int32_t deltaEdge1Y = (p0.mX - p2.mX) << FixedPointVector::kShift;
-        int32_t deltaEdge2Y = (p1.mX - p0.mX) << FixedPointVector::kShift;
-
-        // Compute edge function values for the top-left pixel
-        FixedPointVector topLeftPixel{ xMin + 0.5f, yMin + 0.5f, 0.0f };
-        int32_t edge0 = GetDeterminant(p1, p2, topLeftPixel);
-        int32_t edge1 = GetDeterminant(p2, p0, topLeftPixel);
-        int32_t edge2 = GetDeterminant(p0, p1, topLeftPixel);
-
-        if (IsLeftOrTopEdge(p1, p2)) { edge0--; }
-        if (IsLeftOrTopEdge(p2, p0)) { edge1--; }
-        if (IsLeftOrTopEdge(p0, p1)) { edge2--; }
-
-        // Loop over the bounding box (rasterization)
-        for (int32_t y = yMin; y < yMax; y++)
-        {
-            int32_t e0 = edge0;
-            int32_t e1 = edge1;
-            int32_t e2 = edge2;
-
-            for (int32_t x = xMin; x < xMax; x++)
-            {
-                // Check if the pixel is inside the triangle
-                if (e0 >= 0 && e1 >= 0 && e2 >= 0)
-                {
-                    mColorBuffer.SetPixel(x, y, color);
-                }
-
-                // Step edge functions in X direction
-                e0 += deltaEdge0X;
-                e1 += deltaEdge1X;
-                e2 += deltaEdge2X;
-            }
-
-            // Step edge functions in Y direction
-            edge0 += deltaEdge0Y;
-            edge1 += deltaEdge1Y;
-            edge2 += deltaEdge2Y;
-        }
-    }
-
-    int32_t GetDeterminant(const FixedPointVector& a, const FixedPointVector& b, const FixedPointVector& c)
-    {
-        FixedPointVector ab = b - a;
-        FixedPointVector ac = c - a;
-
-        return ab.mX * ac.mY - ab.mY * ac.mX;
-    }
-
-    bool IsLeftOrTopEdge(const FixedPointVector& start, const FixedPointVector& end)
-    {
-        const FixedPointVector edge = end - start;
-        
-        const bool isTopEdge = (edge.mY == 0) && (edge.mX > 0);
-        const bool isLeftEdge = (edge.mY < 0);
-
-        return (isTopEdge || isLeftEdge);
-    }
-
     glm::vec3 TransformNormal(const glm::mat4& model, const glm::mat4& view, const glm::vec3 normal)
     {
         const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
@@ -936,9 +482,17 @@ private:
     }
 
     glm::vec4 TransformPointFromViewToScreen(const glm::vec2& windowSize, const glm::mat4& projection, const glm::vec4& point)
-    {        
-        // Apply perspective division
-        glm::vec4 transformedPoint = ProjectVec4(projection, point);
+    {
+        return TransformPointFromClipToScreen(windowSize, projection * point);
+    }
+
+    glm::vec4 TransformPointFromClipToScreen(const glm::vec2& windowSize, const glm::vec4& point)
+    {
+        // Apply perspective division, w keeps the view-space depth for perspective-correct interpolation
+        glm::vec4 transformedPoint = point;
+        transformedPoint.x /= point.w;
+        transformedPoint.y /= point.w;
+        transformedPoint.z /= point.w;
 
         // Negate the Y-coordinate to correct for SDL's inverted Y-coordinate system
         transformedPoint.y *= -1.0f;
@@ -968,11 +522,16 @@ private:
     }
 
     glm::vec3 ComputeFaceNormal(const Triangle& triangle)
+    {
+        return ComputeFaceNormal(triangle.mVertices[0].mPoint, triangle.mVertices[1].mPoint, triangle.mVertices[2].mPoint);
+    }
+
+    glm::vec3 ComputeFaceNormal(const glm::vec3& vectorA, const glm::vec3& vectorB, const glm::vec3& vectorC)
     {
         // Check backface culling
-        glm::vec3 vectorA = triangle.mVertices[0].mPoint;  /*   A   */
-        glm::vec3 vectorB = triangle.mVertices[1].mPoint;  /*  / \  */
-        glm::vec3 vectorC = triangle.mVertices[2].mPoint;  /* C---B */
+        /*   A   */
+        /*  / \  */
+        /* C---B */
 
         // Get the vector subtraction of B-A and C-A
         glm::vec3 vectorAB = vectorB - vectorA;
@@ -987,10 +546,10 @@ private:
 		return faceNormal;
     }
 
-    bool IsTriangleFrontFaceVisibleToCamera(const glm::vec3& cameraPosition, const glm::vec3& faceNormal, const Triangle& triangle)
+    bool IsTriangleFrontFaceVisibleToCamera(const glm::vec3& cameraPosition, const glm::vec3& faceNormal, const glm::vec3& vertexA)
     {
         // Find the vector between vertex A in the triangle and the camera origin
-        glm::vec3 cameraRay = cameraPosition - glm::vec3(triangle.mVertices[0].mPoint);
+        glm::vec3 cameraRay = cameraPosition - vertexA;
 		cameraRay = glm::normalize(cameraRay);        
 
 		float dotNormalCamera = glm::dot(faceNormal, cameraRay);
@@ -998,35 +557,35 @@ private:
 		return dotNormalCamera > 0.0f;
     }     
 
-    int32_t EdgeCrossProduct(const glm::ivec2& a, const glm::ivec2& b, const glm::ivec2 point)
-    {
-		return (b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x);
-    }
-
-	bool IsFlatTopOrLeftEdge(const glm::ivec2& start, const glm::ivec2& end)
-	{
-		glm::ivec2 edge = end - start;		
-        bool isFlatTopEdge = (edge.y == 0 && edge.x > 0);
-		bool isLeftEdge = (edge.y < 0);
-
-		return isFlatTopEdge || isLeftEdge;
-	}
-
-	std::vector<Triangle> mTrianglesToRender;
+    // Per-frame storage for transient geometry, reset at the start of every update
+    FrameArena mFrameArena;
+	ArenaVector<Triangle> mTrianglesToRender;
     std::vector<Triangle> mWireframeTrianglesToRender;
     
-    std::unique_ptr<Mesh> mMesh;
-    std::unique_ptr<Texture> mTexture;
+    // Assets drawn this frame, a streamed asset or its placeholder
+    const Mesh* mMesh = nullptr;
+    Texture* mTexture = nullptr;
+    AssetHandle<Mesh> mMeshRequest;
+    AssetHandle<Texture> mTextureRequest;
+    std::unique_ptr<Mesh> mPlaceholderMesh;
+    std::unique_ptr<Texture> mPlaceholderTexture;
     DirectionalLight mDirectionalLight;
 	
 	ColorBuffer mColorBuffer;
     ZBuffer mZBuffer;
+    TileRasterizer mTileRasterizer;
+    RenderState mRenderState;
 	
     Camera mCamera;
     glm::mat4 mProjectionMatrix;
-	std::array<Plane, 6> mClippingPlanes;
-    bool mApplyFillRule = false;
-	std::vector<LineSegment> mLineSegments;
+    ClipGuardBand mClipGuardBand;
+    bool mUseGuardBand = true;
+    TransformedVertexStream mTransformedVertices;
+    std::vector<GeometryChunk> mGeometryChunks;
+	ArenaVector<LineSegment> mLineSegments;
+
+    // Declared last so its thread stops first
+    AssetLoader mAssetLoader;
 };
 
 //------------------------------------------------------------------------------
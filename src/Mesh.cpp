@@ -2,86 +2,564 @@
 
 // Includes
 //------------------------------------------------------------------------------
+// Application
+#include "MeshOptimizer.h"
+
+// Core
+#include "Core/JobSystem.h"
+#include "Core/MappedFile.h"
+
 // System
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <iostream>
-#include <fstream>
-#include <string>
-#include <cstdio>
+#include <numeric>
+#include <span>
+#include <string_view>
+
+//------------------------------------------------------------------------------
+Mesh::Mesh() = default;
+
+//------------------------------------------------------------------------------
+Mesh::~Mesh() = default;
+
+//------------------------------------------------------------------------------
+// Corner attributes compared bit for bit during de-duplication
+struct ImportVertex
+{
+    glm::vec3 mPosition;
+    glm::vec3 mNormal;
+    glm::vec2 mUV;
+
+    bool operator==(const ImportVertex& other) const { return std::memcmp(this, &other, sizeof(ImportVertex)) == 0; }
+};
 
 //------------------------------------------------------------------------------
-void Mesh::Load(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& uvs,                
-                const std::vector<Face>& faces)
+static uint64_t HashImportVertex(const ImportVertex& vertex)
 {
-    mVertices = vertices;
-	mNormals = normals;
-	mUvs = uvs;
-    mFaces = faces;
+    static_assert(sizeof(ImportVertex) == 8 * sizeof(uint32_t), "Error: Import vertex must not contain padding!");
+
+    std::array<uint32_t, 8> words;
+    std::memcpy(words.data(), &vertex, sizeof(ImportVertex));
+
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    for (uint32_t word : words)
+    {
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    return hash;
 }
 
 //------------------------------------------------------------------------------
-std::unique_ptr<Mesh> CreateMeshFromOBJFile(const fs::path& filepath)
+// Returns the index of the unique vertex equal to vertex, adding it first when it is new. The table
+// uses open addressing with linear probing, a slot holds the vertex index plus one or zero when empty.
+static uint32_t FindOrAddImportVertex(const ImportVertex& vertex, std::vector<uint32_t>& slots, std::vector<ImportVertex>& uniqueVertices)
 {
-    std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>();
+    const size_t mask = slots.size() - 1;
+    for (size_t slot = HashImportVertex(vertex) & mask;; slot = (slot + 1) & mask)
+    {
+        if (slots[slot] == 0)
+        {
+            uniqueVertices.push_back(vertex);
+            slots[slot] = static_cast<uint32_t>(uniqueVertices.size());
+            return slots[slot] - 1;
+        }
 
-    std::vector<glm::vec3> vertices;
-	std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> uvs;
-    std::vector<Face> faces;
+        if (uniqueVertices[slots[slot] - 1] == vertex)
+        {
+            return slots[slot] - 1;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Computes a smooth normal for every corner of the faces. A corner averages the normals of the faces around
+// its position that lie within the crease angle of its own face, weighted by their angle at the position, so
+// edges sharper than the crease angle stay hard and the result does not depend on how a surface is tessellated.
+static std::vector<glm::vec3> GenerateCornerNormals(const std::vector<glm::vec3>& vertices, std::span<const Face> faces, Angle creaseAngle)
+{
+    std::vector<glm::vec3> faceNormals(faces.size());
+    std::vector<float> cornerAngles(3 * faces.size());
 
-    std::ifstream file(filepath);
-    if (!file)
+    for (size_t i = 0; i < faces.size(); i++)
     {
-        std::cerr << "Error: Could not open file " << filepath << std::endl;
-        return nullptr;
+        const std::array<int32_t, 3>& indices = faces[i].mVertexIndicies;
+
+        // Same winding as the face normals of the geometry stage
+        const glm::vec3 normal = glm::cross(vertices[indices[1]] - vertices[indices[0]], vertices[indices[2]] - vertices[indices[0]]);
+        const float length = glm::length(normal);
+        faceNormals[i] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+
+        for (size_t j = 0; j < 3; j++)
+        {
+            const glm::vec3 edgeA = vertices[indices[(j + 1) % 3]] - vertices[indices[j]];
+            const glm::vec3 edgeB = vertices[indices[(j + 2) % 3]] - vertices[indices[j]];
+            const float lengths = glm::length(edgeA) * glm::length(edgeB);
+            cornerAngles[3 * i + j] = lengths > 0.0f ? std::acos(std::clamp(glm::dot(edgeA, edgeB) / lengths, -1.0f, 1.0f)) : 0.0f;
+        }
+    }
+
+    // Corners around every position
+    std::vector<uint32_t> adjacencyOffsets(vertices.size() + 1, 0);
+    for (const Face& face : faces)
+    {
+        for (int32_t index : face.mVertexIndicies)
+        {
+            adjacencyOffsets[index + 1]++;
+        }
+    }
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+    std::vector<uint32_t> adjacency(3 * faces.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t corner = 0; corner < adjacency.size(); corner++)
+        {
+            adjacency[fill[faces[corner / 3].mVertexIndicies[corner % 3]]++] = static_cast<uint32_t>(corner);
+        }
+    }
+
+    const float minCosine = std::cos(creaseAngle.AsRadians());
+    std::vector<glm::vec3> cornerNormals(3 * faces.size());
+
+    for (size_t corner = 0; corner < cornerNormals.size(); corner++)
+    {
+        const glm::vec3& faceNormal = faceNormals[corner / 3];
+        const int32_t vertex = faces[corner / 3].mVertexIndicies[corner % 3];
+
+        glm::vec3 normal = glm::vec3(0.0f);
+        for (uint32_t k = adjacencyOffsets[vertex]; k < adjacencyOffsets[vertex + 1]; k++)
+        {
+            const uint32_t neighbor = adjacency[k];
+            const glm::vec3& neighborNormal = faceNormals[neighbor / 3];
+            if (glm::dot(faceNormal, neighborNormal) >= minCosine)
+            {
+                normal += neighborNormal * cornerAngles[neighbor];
+            }
+        }
+
+        const float length = glm::length(normal);
+        cornerNormals[corner] = length > 0.0f ? normal / length : faceNormal;
+    }
+
+    return cornerNormals;
+}
+
+//------------------------------------------------------------------------------
+void Mesh::Load(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& uvs,
+                const std::vector<Face>& faces, Angle creaseAngle)
+{
+    // Faces need a position for every corner, texture coordinates and normals may be missing
+    std::vector<Face> validFaces;
+    validFaces.reserve(faces.size());
+    bool generateNormals = false;
+
+    for (const Face& face : faces)
+    {
+        const auto isValid = [](int32_t index, size_t count) { return index >= 0 && static_cast<size_t>(index) < count; };
+        const auto isValidOrMissing = [&isValid](int32_t index, size_t count) { return index == kMissingFaceIndex || isValid(index, count); };
+
+        bool valid = true;
+        for (size_t j = 0; j < 3; j++)
+        {
+            valid = valid && isValid(face.mVertexIndicies[j], vertices.size());
+            valid = valid && isValidOrMissing(face.mTextureIndicies[j], uvs.size());
+            valid = valid && isValidOrMissing(face.mNormalIndicies[j], normals.size());
+            generateNormals = generateNormals || face.mNormalIndicies[j] == kMissingFaceIndex;
+        }
+
+        if (valid)
+        {
+            validFaces.push_back(face);
+        }
+    }
+
+    // Only faces without a complete set of normals use the generated ones
+    std::vector<glm::vec3> generatedNormals;
+    if (generateNormals)
+    {
+        generatedNormals = GenerateCornerNormals(vertices, validFaces, creaseAngle);
+    }
+
+    std::vector<ImportVertex> uniqueVertices;
+    std::vector<uint32_t> indices;
+    indices.reserve(3 * validFaces.size());
+
+    // At most one vertex per corner, keep the table at most half full
+    size_t slotCount = 16;
+    while (slotCount < 6 * validFaces.size())
+    {
+        slotCount *= 2;
+    }
+    std::vector<uint32_t> slots(slotCount, 0);
+
+    for (size_t i = 0; i < validFaces.size(); i++)
+    {
+        const Face& face = validFaces[i];
+        const bool hasNormals = face.mNormalIndicies[0] != kMissingFaceIndex && face.mNormalIndicies[1] != kMissingFaceIndex &&
+                                face.mNormalIndicies[2] != kMissingFaceIndex;
+
+        for (size_t j = 0; j < 3; j++)
+        {
+            ImportVertex vertex;
+            vertex.mPosition = vertices[face.mVertexIndicies[j]];
+            vertex.mNormal = hasNormals ? normals[face.mNormalIndicies[j]] : generatedNormals[3 * i + j];
+            vertex.mUV = face.mTextureIndicies[j] != kMissingFaceIndex ? uvs[face.mTextureIndicies[j]] : glm::vec2(0.0f);
+            indices.push_back(FindOrAddImportVertex(vertex, slots, uniqueVertices));
+        }
+    }
+
+    // Reorder the triangles for vertex locality and overdraw, then store the vertices in the order they are used
+    std::vector<glm::vec3> positions(uniqueVertices.size());
+    for (size_t i = 0; i < uniqueVertices.size(); i++)
+    {
+        positions[i] = uniqueVertices[i].mPosition;
+    }
+
+    const TriangleOrderStats stats = OptimizeTriangleOrder(indices, positions);
+    std::cout << "Mesh: " << indices.size() / 3 << " triangles, " << uniqueVertices.size() << " vertices, ACMR "
+              << stats.mACMRBefore << " -> " << stats.mACMRAfter << std::endl;
+
+    const std::vector<uint32_t> remap = OptimizeVertexFetch(indices, uniqueVertices.size());
+
+    mPositions.Resize(uniqueVertices.size());
+    mNormals.Resize(uniqueVertices.size());
+    mUvs.Resize(uniqueVertices.size());
+    for (size_t i = 0; i < uniqueVertices.size(); i++)
+    {
+        mPositions.Set(remap[i], uniqueVertices[i].mPosition);
+        mNormals.Set(remap[i], uniqueVertices[i].mNormal);
+        mUvs.Set(remap[i], uniqueVertices[i].mUV);
+    }
+
+    mIndices.Assign(indices, uniqueVertices.size());
+    mStorage.reset();
+}
+
+//------------------------------------------------------------------------------
+void Mesh::View(std::unique_ptr<MappedFile> storage, VertexStream<3> positions, VertexStream<3> normals, VertexStream<2> uvs,
+                IndexBuffer indices)
+{
+    mPositions = std::move(positions);
+    mNormals = std::move(normals);
+    mUvs = std::move(uvs);
+    mIndices = std::move(indices);
+    mStorage = std::move(storage);
+}
+
+//------------------------------------------------------------------------------
+// Files are split into chunks of at least this size, each chunk is parsed as one job
+static constexpr size_t kMinOBJChunkSize = 1 << 20;
+
+//------------------------------------------------------------------------------
+enum class OBJAttribute : uint8_t
+{
+    Vertex,
+    Texture,
+    Normal
+};
+
+//------------------------------------------------------------------------------
+// A face index that counted back from the last attribute, it is relative to the start of its chunk
+// until the attribute counts of the preceding chunks are known
+struct OBJRelativeIndex
+{
+    size_t mFace;
+    uint8_t mCorner;
+    OBJAttribute mAttribute;
+};
+
+//------------------------------------------------------------------------------
+struct OBJChunk
+{
+    std::string_view mText;
+    std::vector<glm::vec3> mVertices;
+    std::vector<glm::vec3> mNormals;
+    std::vector<glm::vec2> mUvs;
+    std::vector<Face> mFaces;
+    std::vector<OBJRelativeIndex> mRelativeIndices;
+};
+
+//------------------------------------------------------------------------------
+static const char* SkipSpaces(const char* cursor, const char* end)
+{
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'))
+    {
+        cursor++;
+    }
+    return cursor;
+}
+
+//------------------------------------------------------------------------------
+static bool ParseFloat(const char*& cursor, const char* end, float& outValue)
+{
+    cursor = SkipSpaces(cursor, end);
+
+    // from_chars does not accept an explicit plus sign
+    if (cursor < end && *cursor == '+')
+    {
+        cursor++;
+    }
+
+    const std::from_chars_result result = std::from_chars(cursor, end, outValue);
+    if (result.ec != std::errc())
+    {
+        return false;
     }
 
-    std::string line;
-    while (std::getline(file, line))
+    cursor = result.ptr;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static bool ParseIndex(const char*& cursor, const char* end, int32_t& outValue)
+{
+    const std::from_chars_result result = std::from_chars(cursor, end, outValue);
+    if (result.ec != std::errc() || outValue == 0)
+    {
+        return false;
+    }
+
+    cursor = result.ptr;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Converts a 1-based OBJ index to 0-based. Negative indices count back from the last attribute
+// parsed so far and are resolved against the start of the chunk.
+static int32_t ResolveOBJIndex(int32_t index, size_t attributeCount, bool& outRelative)
+{
+    outRelative = index < 0;
+    return outRelative ? static_cast<int32_t>(attributeCount) + index : index - 1;
+}
+
+//------------------------------------------------------------------------------
+static void ParseOBJFace(const char* cursor, const char* end, OBJChunk& chunk)
+{
+    struct Corner
+    {
+        std::array<int32_t, 3> mIndices;  // Vertex, texture, normal
+        std::array<bool, 3> mRelative;
+    };
+
+    const std::array<size_t, 3> attributeCounts = { chunk.mVertices.size(), chunk.mUvs.size(), chunk.mNormals.size() };
+
+    // Polygons are triangulated as a fan around the first corner
+    Corner first { };
+    Corner previous { };
+    size_t cornerCount = 0;
+
+    while (true)
     {
-        if (line.empty() || line[0] == '#') continue; // Skip empty lines and comments
+        cursor = SkipSpaces(cursor, end);
+        if (cursor == end)
+        {
+            return;
+        }
+
+        // Corners are v, v/vt, v//vn or v/vt/vn, attributes that are left out are marked missing
+        std::array<int32_t, 3> indices = { 0, 0, 0 };
+        if (!ParseIndex(cursor, end, indices[0]))
+        {
+            return;
+        }
 
-        if (line[0] == 'v' && line[1] == ' ') // Vertex
+        if (cursor < end && *cursor == '/')
+        {
+            cursor++;
+            if ((cursor == end || *cursor != '/') && !ParseIndex(cursor, end, indices[1]))
+            {
+                return;
+            }
+
+            if (cursor < end && *cursor == '/')
+            {
+                cursor++;
+                if (!ParseIndex(cursor, end, indices[2]))
+                {
+                    return;
+                }
+            }
+        }
+
+        Corner corner;
+        for (size_t i = 0; i < 3; i++)
+        {
+            corner.mRelative[i] = false;
+            corner.mIndices[i] = indices[i] != 0 ? ResolveOBJIndex(indices[i], attributeCounts[i], corner.mRelative[i]) : kMissingFaceIndex;
+        }
+
+        if (cornerCount == 0)
+        {
+            first = corner;
+        }
+        else if (cornerCount >= 2)
+        {
+            const std::array<const Corner*, 3> corners = { &first, &previous, &corner };
+
+            Face face;
+            for (uint8_t j = 0; j < 3; j++)
+            {
+                face.mVertexIndicies[j] = corners[j]->mIndices[0];
+                face.mTextureIndicies[j] = corners[j]->mIndices[1];
+                face.mNormalIndicies[j] = corners[j]->mIndices[2];
+
+                for (uint8_t attribute = 0; attribute < 3; attribute++)
+                {
+                    if (corners[j]->mRelative[attribute])
+                    {
+                        chunk.mRelativeIndices.push_back({ chunk.mFaces.size(), j, static_cast<OBJAttribute>(attribute) });
+                    }
+                }
+            }
+            chunk.mFaces.push_back(face);
+        }
+
+        previous = corner;
+        cornerCount++;
+    }
+}
+
+//------------------------------------------------------------------------------
+static void ParseOBJChunk(OBJChunk& chunk)
+{
+    const char* cursor = chunk.mText.data();
+    const char* const textEnd = cursor + chunk.mText.size();
+
+    while (cursor < textEnd)
+    {
+        const char* lineEnd = std::find(cursor, textEnd, '\n');
+        const char* line = SkipSpaces(cursor, lineEnd);
+        cursor = lineEnd + (lineEnd < textEnd ? 1 : 0);
+
+        if (lineEnd - line < 2)
+        {
+            continue;
+        }
+
+        const char* values = line + 2;
+        if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t')) // Vertex
         {
             glm::vec3 vertex;
-            if (sscanf_s(line.c_str(), "v %f %f %f", &vertex.x, &vertex.y, &vertex.z) == 3)
+            if (ParseFloat(values, lineEnd, vertex.x) && ParseFloat(values, lineEnd, vertex.y) && ParseFloat(values, lineEnd, vertex.z))
             {
-                vertices.push_back(vertex);
+                chunk.mVertices.push_back(vertex);
             }
-        }       
-        else if (line[0] == 'v' && line[1] == 'n') // Vertex
+        }
+        else if (line[0] == 'v' && line[1] == 'n') // Normal
         {
             glm::vec3 normal;
-            if (sscanf_s(line.c_str(), "vn %f %f %f", &normal.x, &normal.y, &normal.z) == 3)
+            if (ParseFloat(values, lineEnd, normal.x) && ParseFloat(values, lineEnd, normal.y) && ParseFloat(values, lineEnd, normal.z))
             {
-                normals.push_back(normal);
+                chunk.mNormals.push_back(normal);
             }
-		}
-		else if (line[0] == 'v' && line[1] == 't') // UV
-		{
-			glm::vec2 uv;
-			if (sscanf_s(line.c_str(), "vt %f %f", &uv.x, &uv.y) == 2)
-			{
-				uvs.push_back(uv);
-			}
-		}
-        else if (line[0] == 'f' && line[1] == ' ') // Face
+        }
+        else if (line[0] == 'v' && line[1] == 't') // UV
         {
-            Face face;
-            if (sscanf_s(line.c_str(), "f %d/%d/%d %d/%d/%d %d/%d/%d",
-                &face.mVertexIndicies[0], &face.mTextureIndicies[0], &face.mNormalIndicies[0],
-                &face.mVertexIndicies[1], &face.mTextureIndicies[1], &face.mNormalIndicies[1],
-                &face.mVertexIndicies[2], &face.mTextureIndicies[2], &face.mNormalIndicies[2]) == 9)
+            glm::vec2 uv;
+            if (ParseFloat(values, lineEnd, uv.x) && ParseFloat(values, lineEnd, uv.y))
             {
-				// Convert to 0-based indices
-                face.mVertexIndicies[0]--, face.mTextureIndicies[0]--, face.mNormalIndicies[0]--;
-                face.mVertexIndicies[1]--, face.mTextureIndicies[1]--, face.mNormalIndicies[1]--;
-                face.mVertexIndicies[2]--, face.mTextureIndicies[2]--, face.mNormalIndicies[2]--;
-                
-                faces.push_back(face);
+                chunk.mUvs.push_back(uv);
             }
         }
+        else if (line[0] == 'f' && (line[1] == ' ' || line[1] == '\t')) // Face
+        {
+            ParseOBJFace(values, lineEnd, chunk);
+        }
     }
+}
 
+//------------------------------------------------------------------------------
+// Splits the text into chunks that start at the beginning of a line
+static std::vector<OBJChunk> SplitOBJChunks(std::string_view text, size_t maxChunkCount)
+{
+    const size_t chunkCount = std::clamp<size_t>(text.size() / kMinOBJChunkSize, 1, maxChunkCount);
+
+    std::vector<OBJChunk> chunks(chunkCount);
+    size_t begin = 0;
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        size_t end = text.size();
+        if (i + 1 < chunkCount)
+        {
+            end = std::max(begin, text.size() * (i + 1) / chunkCount);
+            end = std::min(text.find('\n', end), text.size());
+            end += (end < text.size()) ? 1 : 0;
+        }
+
+        chunks[i].mText = text.substr(begin, end - begin);
+        begin = end;
+    }
+
+    return chunks;
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<Mesh> CreateMeshFromOBJFile(const fs::path& filepath, JobSystem& jobSystem)
+{
+    MappedFile file(filepath);
+    if (!file.IsValid())
+    {
+        std::cerr << "Error: Could not open file " << filepath << std::endl;
+        return nullptr;
+    }
+
+    // A few chunks per thread, so threads that finish early can steal the remaining ones
+    std::vector<OBJChunk> chunks = SplitOBJChunks(file.GetContents(), 4 * jobSystem.GetThreadCount());
+    jobSystem.ParallelFor(chunks.size(), 1, [&](size_t index) { ParseOBJChunk(chunks[index]); });
+
+    // Offsets of every chunk's attributes in the merged arrays
+    struct ChunkOffsets
+    {
+        size_t mVertex = 0;
+        size_t mNormal = 0;
+        size_t mUv = 0;
+        size_t mFace = 0;
+    };
+
+    std::vector<ChunkOffsets> offsets(chunks.size());
+    ChunkOffsets totals;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        offsets[i] = totals;
+        totals.mVertex += chunks[i].mVertices.size();
+        totals.mNormal += chunks[i].mNormals.size();
+        totals.mUv += chunks[i].mUvs.size();
+        totals.mFace += chunks[i].mFaces.size();
+    }
+
+    std::vector<glm::vec3> vertices(totals.mVertex);
+    std::vector<glm::vec3> normals(totals.mNormal);
+    std::vector<glm::vec2> uvs(totals.mUv);
+    std::vector<Face> faces(totals.mFace);
+
+    jobSystem.ParallelFor(chunks.size(), 1, [&](size_t index)
+    {
+        OBJChunk& chunk = chunks[index];
+        const ChunkOffsets& offset = offsets[index];
+
+        // Relative indices were resolved against the chunk start, shift them to the merged arrays
+        for (const OBJRelativeIndex& relativeIndex : chunk.mRelativeIndices)
+        {
+            Face& face = chunk.mFaces[relativeIndex.mFace];
+            switch (relativeIndex.mAttribute)
+            {
+                case OBJAttribute::Vertex:  face.mVertexIndicies[relativeIndex.mCorner] += static_cast<int32_t>(offset.mVertex); break;
+                case OBJAttribute::Texture: face.mTextureIndicies[relativeIndex.mCorner] += static_cast<int32_t>(offset.mUv); break;
+                case OBJAttribute::Normal:  face.mNormalIndicies[relativeIndex.mCorner] += static_cast<int32_t>(offset.mNormal); break;
+            }
+        }
+
+        std::copy(chunk.mVertices.begin(), chunk.mVertices.end(), vertices.begin() + offset.mVertex);
+        std::copy(chunk.mNormals.begin(), chunk.mNormals.end(), normals.begin() + offset.mNormal);
+        std::copy(chunk.mUvs.begin(), chunk.mUvs.end(), uvs.begin() + offset.mUv);
+        std::copy(chunk.mFaces.begin(), chunk.mFaces.end(), faces.begin() + offset.mFace);
+    });
+
+    std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>();
     mesh->Load(vertices, normals, uvs, faces);
     return mesh;
 }
\ No newline at end of file
@@ -3,21 +3,38 @@
 // Includes
 //------------------------------------------------------------------------------
 // Application
+#include "IndexBuffer.h"
 #include "Trangle.h"
+#include "VertexStream.h"
+
+// Core
+#include "Core/Angle.h"
 
 // Third Party
 #include <glm/glm.hpp>
 
 // System
 #include <filesystem>
+#include <limits>
 #include <vector>
 #include <memory>
 
+// Forward Declarations
+//------------------------------------------------------------------------------
+class JobSystem;
+class MappedFile;
+
 // Type Alias
 //------------------------------------------------------------------------------
 namespace fs = std::filesystem;
 
+// Constants
+//------------------------------------------------------------------------------
+// Face index of an attribute the OBJ file left out, for example the normal of a v/vt corner
+constexpr int32_t kMissingFaceIndex = std::numeric_limits<int32_t>::min();
+
 //------------------------------------------------------------------------------
+// Triangle as written in an OBJ file, every attribute has its own index. Only used during import.
 struct Face
 {
 	std::array<int32_t, 3> mVertexIndicies;
@@ -25,25 +42,53 @@ struct Face
 	std::array<int32_t, 3> mNormalIndicies;
 };
 
+/*
+    Indexed triangle mesh. Import merges the (position, uv, normal) combinations used by the
+    faces into unified vertices, so every corner that repeats a combination shares the vertex
+    and a single index buffer describes the triangles. Attributes are stored as
+    structure-of-arrays streams for the batched vertex stage. A mesh either owns its data or
+    views a memory-mapped mesh cache in place, see MeshCache.h.
+*/
 //------------------------------------------------------------------------------
 class Mesh
 {
 public:
+	Mesh();
+	~Mesh();
+
+	// Builds the unified vertices and the index buffer, faces that reference attributes out of range are dropped.
+	// Faces without normals get smooth normals, averaged over the neighbor faces within the crease angle.
 	void Load(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& uvs,
-			  const std::vector<Face>& faces);
+			  const std::vector<Face>& faces, Angle creaseAngle = Angle::Degrees(60.0f));
+
+	// Views data that lives in storage without copying it, the mesh keeps storage alive
+	void View(std::unique_ptr<MappedFile> storage, VertexStream<3> positions, VertexStream<3> normals, VertexStream<2> uvs,
+			  IndexBuffer indices);
 	
-	size_t FaceCount() const { return mFaces.size(); }
-	const glm::vec3& GetVertex(size_t index) const { return mVertices[index]; }
-	const glm::vec3& GetNormal(size_t index) const { return mNormals[index]; }
-	const glm::vec2& GetUV(size_t index) const { return mUvs[index]; }
-	const Face& GetFace(size_t index) const { return mFaces[index]; }
+	size_t FaceCount() const { return mIndices.GetSize() / 3; }
+	size_t VertexCount() const { return mPositions.GetSize(); }
+	glm::vec3 GetVertex(size_t index) const { return mPositions.Get(index); }
+	glm::vec3 GetNormal(size_t index) const { return mNormals.Get(index); }
+	glm::vec2 GetUV(size_t index) const { return mUvs.Get(index); }
+
+	std::array<uint32_t, 3> GetTriangle(size_t face) const
+	{
+		return { mIndices.Get(3 * face), mIndices.Get(3 * face + 1), mIndices.Get(3 * face + 2) };
+	}
+
+	const VertexStream<3>& GetPositions() const { return mPositions; }
+	const VertexStream<3>& GetNormals() const { return mNormals; }
+	const VertexStream<2>& GetUvs() const { return mUvs; }
+	const IndexBuffer& GetIndices() const { return mIndices; }
 	
 private:
-	std::vector<glm::vec3> mVertices;
-	std::vector<glm::vec3> mNormals;
-	std::vector<glm::vec2> mUvs;
-	std::vector<Face> mFaces;
+	VertexStream<3> mPositions;
+	VertexStream<3> mNormals;
+	VertexStream<2> mUvs;
+	IndexBuffer mIndices;
+	std::unique_ptr<MappedFile> mStorage;
 };
 
 //------------------------------------------------------------------------------
-std::unique_ptr<Mesh> CreateMeshFromOBJFile(const fs::path& filepath);
\ No newline at end of file
+// Memory-maps the file and parses it in chunks on the job system
+std::unique_ptr<Mesh> CreateMeshFromOBJFile(const fs::path& filepath, JobSystem& jobSystem);
\ No newline at end of file
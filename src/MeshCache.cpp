@@ -0,0 +1,229 @@
+#include "MeshCache.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "CacheFile.h"
+#include "Mesh.h"
+
+// Core
+#include "Core/MappedFile.h"
+
+// System
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+static constexpr std::array<char, 4> kMeshCacheMagic = { 'M', 'S', 'H', 'C' };
+static constexpr uint32_t kMeshCacheVersion = 4;
+static constexpr uint32_t kMeshCacheByteOrder = 0x01020304;  // Reads back differently on a host of the other endianness
+
+//------------------------------------------------------------------------------
+struct MeshCacheHeader
+{
+    std::array<char, 4> mMagic;
+    uint32_t mVersion;
+    uint32_t mByteOrder;
+    uint32_t mIndexFormat;
+    uint64_t mFileSize;
+    uint64_t mSourceSize;
+    int64_t mSourceWriteTime;
+
+    uint64_t mVertexCount;
+    uint64_t mIndexCount;
+
+    uint64_t mPositionsOffset;
+    uint64_t mNormalsOffset;
+    uint64_t mUvsOffset;
+    uint64_t mIndicesOffset;
+};
+
+//------------------------------------------------------------------------------
+template<size_t ComponentCount>
+static uint64_t GetStreamBlockSize(uint64_t count)
+{
+    return ComponentCount * VertexStream<ComponentCount>::GetPaddedSize(count) * sizeof(float);
+}
+
+//------------------------------------------------------------------------------
+template<size_t ComponentCount>
+static void WriteStreamBlock(std::ofstream& file, const VertexStream<ComponentCount>& stream)
+{
+    // Streams keep their padding zeroed, so the padded arrays are written as is
+    for (size_t component = 0; component < ComponentCount; component++)
+    {
+        file.write(reinterpret_cast<const char*>(stream.GetComponent(component)), stream.GetPaddedSize() * sizeof(float));
+    }
+}
+
+//------------------------------------------------------------------------------
+template<size_t ComponentCount>
+static VertexStream<ComponentCount> ViewStreamBlock(const char* data, uint64_t offset, uint64_t count)
+{
+    const float* block = reinterpret_cast<const float*>(data + offset);
+    const size_t paddedSize = VertexStream<ComponentCount>::GetPaddedSize(count);
+
+    std::array<const float*, ComponentCount> components;
+    for (size_t component = 0; component < ComponentCount; component++)
+    {
+        components[component] = block + component * paddedSize;
+    }
+
+    VertexStream<ComponentCount> stream;
+    stream.View(components, count);
+    return stream;
+}
+
+//------------------------------------------------------------------------------
+fs::path GetMeshCachePath(const fs::path& sourcePath)
+{
+    fs::path cachePath = sourcePath;
+    cachePath += ".meshcache";
+    return cachePath;
+}
+
+//------------------------------------------------------------------------------
+bool WriteMeshCache(const Mesh& mesh, const fs::path& cachePath, const fs::path& sourcePath)
+{
+    CacheFileSource source;
+    if (!QueryCacheFileSource(sourcePath, source))
+    {
+        return false;
+    }
+
+    MeshCacheHeader header { };
+    header.mMagic = kMeshCacheMagic;
+    header.mVersion = kMeshCacheVersion;
+    header.mByteOrder = kMeshCacheByteOrder;
+    header.mIndexFormat = static_cast<uint32_t>(mesh.GetIndices().GetFormat());
+    header.mSourceSize = source.mSize;
+    header.mSourceWriteTime = source.mWriteTime;
+    header.mVertexCount = mesh.GetPositions().GetSize();
+    header.mIndexCount = mesh.GetIndices().GetSize();
+
+    header.mPositionsOffset = AlignCacheOffset(sizeof(MeshCacheHeader));
+    header.mNormalsOffset = AlignCacheOffset(header.mPositionsOffset + GetStreamBlockSize<3>(header.mVertexCount));
+    header.mUvsOffset = AlignCacheOffset(header.mNormalsOffset + GetStreamBlockSize<3>(header.mVertexCount));
+    header.mIndicesOffset = AlignCacheOffset(header.mUvsOffset + GetStreamBlockSize<2>(header.mVertexCount));
+    header.mFileSize = header.mIndicesOffset + mesh.GetIndices().GetSizeInBytes();
+
+    // Write to a temporary file first, readers never see a partially written cache
+    fs::path temporaryPath = cachePath;
+    temporaryPath += ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WriteCachePadding(file, sizeof(header));
+        WriteStreamBlock(file, mesh.GetPositions());
+        WriteCachePadding(file, header.mPositionsOffset + GetStreamBlockSize<3>(header.mVertexCount));
+        WriteStreamBlock(file, mesh.GetNormals());
+        WriteCachePadding(file, header.mNormalsOffset + GetStreamBlockSize<3>(header.mVertexCount));
+        WriteStreamBlock(file, mesh.GetUvs());
+        WriteCachePadding(file, header.mUvsOffset + GetStreamBlockSize<2>(header.mVertexCount));
+        file.write(reinterpret_cast<const char*>(mesh.GetIndices().GetData()), mesh.GetIndices().GetSizeInBytes());
+
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporaryPath, cachePath, error);
+    return !error;
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<Mesh> LoadMeshCache(const fs::path& cachePath, const fs::path& sourcePath)
+{
+    std::error_code error;
+    if (!fs::exists(cachePath, error))
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>(cachePath);
+    if (!file->IsValid() || file->GetContents().size() < sizeof(MeshCacheHeader))
+    {
+        return nullptr;
+    }
+
+    const char* data = file->GetContents().data();
+    MeshCacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.mMagic != kMeshCacheMagic || header.mVersion != kMeshCacheVersion || header.mByteOrder != kMeshCacheByteOrder ||
+        header.mIndexFormat > static_cast<uint32_t>(IndexFormat::UInt32) || header.mFileSize != file->GetContents().size())
+    {
+        return nullptr;
+    }
+
+    // A cache without its source is still usable, a changed source makes it stale
+    CacheFileSource source;
+    if (QueryCacheFileSource(sourcePath, source) && (source.mSize != header.mSourceSize || source.mWriteTime != header.mSourceWriteTime))
+    {
+        return nullptr;
+    }
+
+    // Counts no file this size could hold would wrap the block sizes below into small ones
+    const IndexFormat indexFormat = static_cast<IndexFormat>(header.mIndexFormat);
+    if (header.mVertexCount > header.mFileSize / (3 * sizeof(float)) ||
+        header.mIndexCount > header.mFileSize / IndexBuffer::GetIndexSize(indexFormat) || header.mIndexCount % 3 != 0)
+    {
+        return nullptr;
+    }
+
+    if (!IsCacheBlockValid(header.mPositionsOffset, GetStreamBlockSize<3>(header.mVertexCount), sizeof(MeshCacheHeader), header.mFileSize) ||
+        !IsCacheBlockValid(header.mNormalsOffset, GetStreamBlockSize<3>(header.mVertexCount), sizeof(MeshCacheHeader), header.mFileSize) ||
+        !IsCacheBlockValid(header.mUvsOffset, GetStreamBlockSize<2>(header.mVertexCount), sizeof(MeshCacheHeader), header.mFileSize) ||
+        !IsCacheBlockValid(header.mIndicesOffset, header.mIndexCount * IndexBuffer::GetIndexSize(indexFormat), sizeof(MeshCacheHeader), header.mFileSize))
+    {
+        return nullptr;
+    }
+
+    IndexBuffer indices;
+    indices.View(data + header.mIndicesOffset, header.mIndexCount, indexFormat);
+
+    // Indices are read on every frame without bounds checks, a corrupted cache must not point past the vertices
+    for (size_t i = 0; i < indices.GetSize(); i++)
+    {
+        if (indices.Get(i) >= header.mVertexCount)
+        {
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>();
+    mesh->View(std::move(file),
+        ViewStreamBlock<3>(data, header.mPositionsOffset, header.mVertexCount),
+        ViewStreamBlock<3>(data, header.mNormalsOffset, header.mVertexCount),
+        ViewStreamBlock<2>(data, header.mUvsOffset, header.mVertexCount),
+        std::move(indices));
+    return mesh;
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<Mesh> LoadMesh(const fs::path& sourcePath, JobSystem& jobSystem)
+{
+    const fs::path cachePath = GetMeshCachePath(sourcePath);
+    if (std::unique_ptr<Mesh> mesh = LoadMeshCache(cachePath, sourcePath))
+    {
+        return mesh;
+    }
+
+    std::unique_ptr<Mesh> mesh = CreateMeshFromOBJFile(sourcePath, jobSystem);
+    if (mesh && !WriteMeshCache(*mesh, cachePath, sourcePath))
+    {
+        std::cerr << "Warning: Could not write mesh cache " << cachePath << std::endl;
+    }
+
+    return mesh;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <filesystem>
+#include <memory>
+
+// Forward Declarations
+//------------------------------------------------------------------------------
+class JobSystem;
+class Mesh;
+
+// Type Alias
+//------------------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+/*
+    Binary mesh cache. The file starts with a versioned header followed by 64 byte aligned
+    blocks for positions, normals, UVs and the index buffer. Attribute blocks hold one padded
+    array per component in the VertexStream layout and the indices keep their 16 or 32-bit
+    format, so a loaded mesh views the read-only mapping directly and processes that map the
+    same cache share its pages.
+
+    The header records the size and write time of the source file, a cache whose source
+    changed is treated as missing.
+*/
+//------------------------------------------------------------------------------
+fs::path GetMeshCachePath(const fs::path& sourcePath);
+bool WriteMeshCache(const Mesh& mesh, const fs::path& cachePath, const fs::path& sourcePath);
+
+// Returns null when the cache is missing, stale or malformed
+std::unique_ptr<Mesh> LoadMeshCache(const fs::path& cachePath, const fs::path& sourcePath);
+
+// Loads the mesh from its cache when the cache is up to date, otherwise imports the OBJ file and writes the cache
+std::unique_ptr<Mesh> LoadMesh(const fs::path& sourcePath, JobSystem& jobSystem);
\ No newline at end of file
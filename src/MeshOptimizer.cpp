@@ -0,0 +1,446 @@
+#include "MeshOptimizer.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+//------------------------------------------------------------------------------
+// Forsyth's scoring parameters, tuned for an LRU cache of kVertexCacheSize entries
+static constexpr float kCacheDecayPower = 1.5f;
+static constexpr float kLastTriangleScore = 0.75f;
+static constexpr float kValenceBoostScale = 2.0f;
+static constexpr float kValenceBoostPower = 0.5f;
+static constexpr size_t kMaxScoredValence = 32;
+
+//------------------------------------------------------------------------------
+struct VertexScoreTable
+{
+    std::array<float, kVertexCacheSize> mCachePosition;
+    std::array<float, kMaxScoredValence + 1> mValence;
+
+    VertexScoreTable()
+    {
+        for (size_t position = 0; position < kVertexCacheSize; position++)
+        {
+            // The vertices of the last triangle get a fixed score, so the next triangle does not simply reuse its edge
+            if (position < 3)
+            {
+                mCachePosition[position] = kLastTriangleScore;
+            }
+            else
+            {
+                const float scale = 1.0f / static_cast<float>(kVertexCacheSize - 3);
+                mCachePosition[position] = std::pow(1.0f - static_cast<float>(position - 3) * scale, kCacheDecayPower);
+            }
+        }
+
+        // Vertices with few triangles left are boosted, finishing them removes them from the working set
+        mValence[0] = 0.0f;
+        for (size_t valence = 1; valence <= kMaxScoredValence; valence++)
+        {
+            mValence[valence] = kValenceBoostScale * std::pow(static_cast<float>(valence), -kValenceBoostPower);
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+static float ComputeVertexScore(const VertexScoreTable& table, int32_t cachePosition, uint32_t remainingValence)
+{
+    if (remainingValence == 0)
+    {
+        return -1.0f;  // No triangle left to draw
+    }
+
+    const float cacheScore = cachePosition >= 0 ? table.mCachePosition[cachePosition] : 0.0f;
+    return cacheScore + table.mValence[std::min<size_t>(remainingValence, kMaxScoredValence)];
+}
+
+//------------------------------------------------------------------------------
+// FIFO cache simulation shared by ComputeACMR and the overdraw clustering. Returns the number of misses.
+class FIFOVertexCache
+{
+public:
+    FIFOVertexCache(size_t vertexCount, size_t cacheSize)
+        : mTimestamps(vertexCount, 0)
+        , mCacheSize(cacheSize)
+        , mTime(cacheSize + 1)
+    { }
+
+    uint32_t AddTriangle(const uint32_t* triangle)
+    {
+        uint32_t misses = 0;
+        for (size_t j = 0; j < 3; j++)
+        {
+            // A vertex is cached when fewer than cacheSize misses happened since it was loaded
+            if (mTime - mTimestamps[triangle[j]] > mCacheSize)
+            {
+                mTimestamps[triangle[j]] = mTime++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    // Evicts every vertex, the next triangle starts cold
+    void Flush()
+    {
+        mTime += mCacheSize + 1;
+    }
+
+private:
+    std::vector<size_t> mTimestamps;
+    size_t mCacheSize;
+    size_t mTime;
+};
+
+//------------------------------------------------------------------------------
+float ComputeACMR(std::span<const uint32_t> indices, size_t vertexCount, size_t cacheSize)
+{
+    assert(indices.size() % 3 == 0 && "Error: Index count must be a multiple of 3!");
+
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return 0.0f;
+    }
+
+    FIFOVertexCache cache(vertexCount, cacheSize);
+    size_t misses = 0;
+    for (size_t i = 0; i < triangleCount; i++)
+    {
+        misses += cache.AddTriangle(&indices[3 * i]);
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+//------------------------------------------------------------------------------
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount)
+{
+    assert(indices.size() % 3 == 0 && "Error: Index count must be a multiple of 3!");
+
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    static const VertexScoreTable kScoreTable;
+
+    // Triangles adjacent to every vertex, the first remainingValence entries of a vertex are not drawn yet
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32_t index : indices)
+    {
+        adjacencyOffsets[index + 1]++;
+    }
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+    std::vector<uint32_t> remainingValence(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; vertex++)
+    {
+        remainingValence[vertex] = adjacencyOffsets[vertex + 1] - adjacencyOffsets[vertex];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int32_t> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; vertex++)
+    {
+        vertexScores[vertex] = ComputeVertexScore(kScoreTable, -1, remainingValence[vertex]);
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    // The cache holds the vertices of the emitted triangle in front of the previous contents, three extra slots
+    // keep the vertices that fall out of the cache so their scores can be updated
+    std::array<uint32_t, kVertexCacheSize + 3> cache;
+    std::array<uint32_t, kVertexCacheSize + 3> nextCache;
+    size_t cacheCount = 0;
+
+    size_t inputCursor = 0;
+    int64_t bestTriangle = -1;
+
+    while (true)
+    {
+        // Dead end, nothing adjacent to the cache is left. Continue with the next triangle in input order.
+        if (bestTriangle < 0)
+        {
+            while (inputCursor < triangleCount && emitted[inputCursor])
+            {
+                inputCursor++;
+            }
+
+            if (inputCursor == triangleCount)
+            {
+                break;
+            }
+
+            bestTriangle = static_cast<int64_t>(inputCursor);
+        }
+
+        const uint32_t* triangle = &indices[3 * bestTriangle];
+        result.insert(result.end(), triangle, triangle + 3);
+        emitted[bestTriangle] = true;
+
+        // Remove the triangle from the pending lists of its vertices
+        for (size_t j = 0; j < 3; j++)
+        {
+            const uint32_t vertex = triangle[j];
+            uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+            uint32_t* end = begin + remainingValence[vertex];
+
+            uint32_t* found = std::find(begin, end, static_cast<uint32_t>(bestTriangle));
+            assert(found != end && "Error: Triangle is missing from the adjacency of its vertex!");
+            std::swap(*found, *(end - 1));
+            remainingValence[vertex]--;
+        }
+
+        // Move the triangle's vertices to the front of the cache
+        size_t nextCount = 0;
+        for (size_t j = 0; j < 3; j++)
+        {
+            nextCache[nextCount++] = triangle[j];
+        }
+
+        for (size_t k = 0; k < cacheCount; k++)
+        {
+            const uint32_t vertex = cache[k];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+            {
+                nextCache[nextCount++] = vertex;
+            }
+        }
+
+        std::swap(cache, nextCache);
+        cacheCount = nextCount;
+
+        // Rescore the cached vertices, the ones past the cache size were just evicted
+        for (size_t k = 0; k < cacheCount; k++)
+        {
+            const uint32_t vertex = cache[k];
+            cachePositions[vertex] = k < kVertexCacheSize ? static_cast<int32_t>(k) : -1;
+            vertexScores[vertex] = ComputeVertexScore(kScoreTable, cachePositions[vertex], remainingValence[vertex]);
+        }
+
+        // Only triangles touching the cache changed their score, the best of them is drawn next
+        bestTriangle = -1;
+        float bestScore = 0.0f;
+        for (size_t k = 0; k < cacheCount; k++)
+        {
+            const uint32_t vertex = cache[k];
+            const uint32_t* pending = &adjacency[adjacencyOffsets[vertex]];
+
+            for (uint32_t p = 0; p < remainingValence[vertex]; p++)
+            {
+                const uint32_t candidate = pending[p];
+                const uint32_t* candidateIndices = &indices[3 * candidate];
+                const float score = vertexScores[candidateIndices[0]] + vertexScores[candidateIndices[1]] + vertexScores[candidateIndices[2]];
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = candidate;
+                }
+            }
+        }
+
+        cacheCount = std::min(cacheCount, kVertexCacheSize);
+    }
+
+    assert(result.size() == indices.size() && "Error: Every triangle must be emitted once!");
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+//------------------------------------------------------------------------------
+// Splits the triangle list into clusters that can be reordered without raising the ACMR by more than the
+// threshold. Hard boundaries are where all three vertices miss, soft boundaries are placed inside those
+// clusters once the ACMR of the part since the last boundary is good enough. Returns the first triangle
+// of every cluster.
+static std::vector<size_t> ComputeOverdrawClusters(std::span<const uint32_t> indices, size_t vertexCount, float threshold)
+{
+    const size_t triangleCount = indices.size() / 3;
+
+    std::vector<size_t> hardBoundaries;
+    {
+        FIFOVertexCache cache(vertexCount, kVertexCacheSize);
+        for (size_t i = 0; i < triangleCount; i++)
+        {
+            if (cache.AddTriangle(&indices[3 * i]) == 3)
+            {
+                hardBoundaries.push_back(i);
+            }
+        }
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    std::vector<size_t> clusters;
+    FIFOVertexCache cache(vertexCount, kVertexCacheSize);
+
+    for (size_t h = 0; h + 1 < hardBoundaries.size(); h++)
+    {
+        const size_t begin = hardBoundaries[h];
+        const size_t end = hardBoundaries[h + 1];
+
+        cache.Flush();
+        size_t clusterMisses = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            clusterMisses += cache.AddTriangle(&indices[3 * i]);
+        }
+        const float maxACMR = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        // Every soft cluster starts with a cold cache, which is what it sees after being moved
+        cache.Flush();
+        clusters.push_back(begin);
+        size_t misses = 0;
+        size_t count = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            misses += cache.AddTriangle(&indices[3 * i]);
+            count++;
+
+            if (i + 1 < end && static_cast<float>(misses) <= maxACMR * static_cast<float>(count))
+            {
+                cache.Flush();
+                clusters.push_back(i + 1);
+                misses = 0;
+                count = 0;
+            }
+        }
+    }
+
+    return clusters;
+}
+
+//------------------------------------------------------------------------------
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const glm::vec3> positions, float threshold)
+{
+    assert(indices.size() % 3 == 0 && "Error: Index count must be a multiple of 3!");
+
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    std::vector<size_t> clusters = ComputeOverdrawClusters(indices, positions.size(), threshold);
+    clusters.push_back(triangleCount);
+
+    // Area weighted centroid and normal of every cluster, the length of a cross product is twice the area
+    struct Cluster
+    {
+        glm::vec3 mCentroid = glm::vec3(0.0f);
+        glm::vec3 mNormal = glm::vec3(0.0f);
+        float mArea = 0.0f;
+        float mSortKey = 0.0f;
+    };
+
+    std::vector<Cluster> clusterData(clusters.size() - 1);
+    glm::vec3 meshCentroid = glm::vec3(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c + 1 < clusters.size(); c++)
+    {
+        Cluster& cluster = clusterData[c];
+        for (size_t i = clusters[c]; i < clusters[c + 1]; i++)
+        {
+            const glm::vec3& a = positions[indices[3 * i]];
+            const glm::vec3& b = positions[indices[3 * i + 1]];
+            const glm::vec3& d = positions[indices[3 * i + 2]];
+
+            const glm::vec3 normal = glm::cross(b - a, d - a);
+            const float area = glm::length(normal);
+
+            cluster.mCentroid += (a + b + d) * (area / 3.0f);
+            cluster.mNormal += normal;
+            cluster.mArea += area;
+        }
+
+        meshCentroid += cluster.mCentroid;
+        meshArea += cluster.mArea;
+        cluster.mCentroid = cluster.mArea > 0.0f ? cluster.mCentroid / cluster.mArea : cluster.mCentroid;
+    }
+
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+    for (Cluster& cluster : clusterData)
+    {
+        const float normalLength = glm::length(cluster.mNormal);
+        const glm::vec3 normal = normalLength > 0.0f ? cluster.mNormal / normalLength : cluster.mNormal;
+        cluster.mSortKey = glm::dot(cluster.mCentroid - meshCentroid, normal);
+    }
+
+    // Clusters that face away from the center the most go first, equal keys keep their cache order
+    std::vector<size_t> order(clusterData.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&clusterData](size_t lhs, size_t rhs)
+    {
+        return clusterData[lhs].mSortKey > clusterData[rhs].mSortKey;
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (size_t c : order)
+    {
+        result.insert(result.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * clusters[c + 1]);
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+//------------------------------------------------------------------------------
+TriangleOrderStats OptimizeTriangleOrder(std::span<uint32_t> indices, std::span<const glm::vec3> positions)
+{
+    TriangleOrderStats stats;
+    stats.mACMRBefore = ComputeACMR(indices, positions.size());
+
+    OptimizeVertexCache(indices, positions.size());
+    OptimizeOverdraw(indices, positions);
+
+    stats.mACMRAfter = ComputeACMR(indices, positions.size());
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint32_t> OptimizeVertexFetch(std::span<uint32_t> indices, size_t vertexCount)
+{
+    static constexpr uint32_t kUnused = UINT32_MAX;
+
+    std::vector<uint32_t> remap(vertexCount, kUnused);
+    uint32_t nextVertex = 0;
+
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == kUnused)
+        {
+            remap[index] = nextVertex++;
+        }
+        index = remap[index];
+    }
+
+    // Vertices no triangle references keep their relative order after the used ones
+    for (uint32_t& vertex : remap)
+    {
+        if (vertex == kUnused)
+        {
+            vertex = nextVertex++;
+        }
+    }
+
+    return remap;
+}
\ No newline at end of file
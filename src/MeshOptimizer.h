@@ -0,0 +1,54 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// Third party
+#include <glm/glm.hpp>
+
+// System
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Constants
+//------------------------------------------------------------------------------
+// Size of the simulated post-transform cache, reordering targets it and ACMR is measured with it
+constexpr size_t kVertexCacheSize = 32;
+
+// Clusters may be reordered for overdraw as long as their ACMR stays within this factor of the cache optimized order
+constexpr float kOverdrawACMRThreshold = 1.05f;
+
+/*
+    Load-time triangle reordering. Triangle lists are first ordered for vertex locality with
+    Forsyth's linear-speed vertex cache optimization. The result is then split into clusters
+    at points where the cache would start cold anyway, and the clusters are sorted so the
+    ones facing outwards from the mesh center come first (Sander et al., "Fast Triangle
+    Reordering for Vertex Locality and Reduced Overdraw"). Outward clusters tend to occlude
+    the rest, which lets the depth test reject more of the later pixels before they are shaded.
+
+    Every function works on a triangle list of indices into vertexCount vertices.
+*/
+//------------------------------------------------------------------------------
+struct TriangleOrderStats
+{
+    float mACMRBefore = 0.0f;
+    float mACMRAfter = 0.0f;
+};
+
+//------------------------------------------------------------------------------
+// Average cache miss ratio, the number of vertices transformed per triangle by a FIFO cache of the given size.
+// 3 is the worst case, a regular grid approaches 0.5.
+float ComputeACMR(std::span<const uint32_t> indices, size_t vertexCount, size_t cacheSize = kVertexCacheSize);
+
+// Reorders the triangles for post-transform cache hits
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+
+// Reorders clusters of a cache optimized triangle list from the outside of the mesh inwards
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const glm::vec3> positions, float threshold = kOverdrawACMRThreshold);
+
+// Runs both passes and returns the ACMR of the input and the result
+TriangleOrderStats OptimizeTriangleOrder(std::span<uint32_t> indices, std::span<const glm::vec3> positions);
+
+// Returns the new position of every vertex when vertices are stored in the order the triangles first use them,
+// and rewrites the indices accordingly. Triangle assembly then walks the vertex arrays mostly forwards.
+std::vector<uint32_t> OptimizeVertexFetch(std::span<uint32_t> indices, size_t vertexCount);
\ No newline at end of file
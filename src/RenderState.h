@@ -0,0 +1,55 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// System
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+enum class PolygonMode : uint8_t
+{
+    Fill,
+    Wireframe
+};
+
+//------------------------------------------------------------------------------
+enum class LightingMode : uint8_t
+{
+    None,   // Colors are used as is
+    Flat,   // The intensity of the first vertex is applied to the whole triangle
+    Smooth  // Vertex intensities are interpolated across the triangle
+};
+
+//------------------------------------------------------------------------------
+enum class FillRule : uint8_t
+{
+    TopLeft,   // Pixels on shared edges belong to exactly one triangle
+    Inclusive  // Pixels on edges belong to every triangle touching them
+};
+
+//------------------------------------------------------------------------------
+enum class BlendMode : uint8_t
+{
+    Opaque,
+    Alpha  // Source over destination, alpha is the lowest byte of the RGBA8888 color
+};
+
+/*
+    Describes how triangles are drawn. The per-pixel features (depth test/write, texturing,
+    lighting and blending) select a rasterizer specialization once per draw, so features that
+    are disabled are compiled out of the inner loop instead of being branched over per pixel.
+    Textured draws also specialize on the bound texture's addressing, filter, texel format and
+    layout, so every fetch decodes exactly one format.
+*/
+//------------------------------------------------------------------------------
+struct RenderState
+{
+    PolygonMode mPolygonMode = PolygonMode::Fill;
+    bool mDepthTest = true;
+    bool mDepthWrite = true;
+    bool mTextured = true;
+    LightingMode mLighting = LightingMode::Smooth;
+    FillRule mFillRule = FillRule::TopLeft;
+    BlendMode mBlend = BlendMode::Opaque;
+    uint32_t mWireframeColor = 0xFFFFFFFF;
+};
\ No newline at end of file
@@ -0,0 +1,396 @@
+#include "Texture.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "TextureSampler.h"
+
+// Core
+#include "Core/MappedFile.h"
+
+// System
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+
+//------------------------------------------------------------------------------
+// Box filters a level down to the next one, a source dimension of 1 reads its single texel twice
+static std::vector<uint32_t> GenerateMipLevel(const std::vector<uint32_t>& source, const glm::ivec2& sourceSize, const glm::ivec2& size)
+{
+	std::vector<uint32_t> pixels(static_cast<size_t>(size.x) * size.y);
+
+	for (int32_t y = 0; y < size.y; y++)
+	{
+		for (int32_t x = 0; x < size.x; x++)
+		{
+			const int32_t x0 = std::min(2 * x, sourceSize.x - 1);
+			const int32_t x1 = std::min(2 * x + 1, sourceSize.x - 1);
+			const int32_t y0 = std::min(2 * y, sourceSize.y - 1);
+			const int32_t y1 = std::min(2 * y + 1, sourceSize.y - 1);
+
+			const uint32_t texels[4] = {
+				source[y0 * sourceSize.x + x0],
+				source[y0 * sourceSize.x + x1],
+				source[y1 * sourceSize.x + x0],
+				source[y1 * sourceSize.x + x1]
+			};
+
+			uint32_t color = 0;
+			for (uint32_t shift = 0; shift < 32; shift += 8)
+			{
+				uint32_t sum = 2;  // Round to nearest
+				for (uint32_t texel : texels)
+				{
+					sum += (texel >> shift) & 0xFF;
+				}
+				color |= (sum / 4) << shift;
+			}
+
+			pixels[y * size.x + x] = color;
+		}
+	}
+
+	return pixels;
+}
+
+//------------------------------------------------------------------------------
+// Sorted distinct colors of the pixels, fails for more than a palette can hold
+static bool BuildPalette(const std::vector<uint32_t>& pixels, std::vector<uint32_t>& palette)
+{
+	palette = pixels;
+	std::sort(palette.begin(), palette.end());
+	palette.erase(std::unique(palette.begin(), palette.end()), palette.end());
+	return palette.size() <= kTexturePaletteSize;
+}
+
+//------------------------------------------------------------------------------
+static int32_t ColorDistance(uint32_t a, uint32_t b)
+{
+	int32_t distance = 0;
+	for (uint32_t shift = 0; shift < 32; shift += 8)
+	{
+		const int32_t delta = static_cast<int32_t>((a >> shift) & 0xFF) - static_cast<int32_t>((b >> shift) & 0xFF);
+		distance += delta * delta;
+	}
+	return distance;
+}
+
+//------------------------------------------------------------------------------
+static uint8_t FindNearestPaletteEntry(const std::vector<uint32_t>& palette, uint32_t color)
+{
+	size_t nearest = 0;
+	for (size_t i = 1; i < palette.size(); i++)
+	{
+		if (ColorDistance(palette[i], color) < ColorDistance(palette[nearest], color))
+		{
+			nearest = i;
+		}
+	}
+	return static_cast<uint8_t>(nearest);
+}
+
+//------------------------------------------------------------------------------
+static uint16_t EncodeRGB565(const glm::vec3& color)
+{
+	const glm::ivec3 quantized = glm::ivec3(glm::clamp(color, 0.0f, 255.0f) * glm::vec3(31.0f, 63.0f, 31.0f) / 255.0f + 0.5f);
+	return static_cast<uint16_t>(quantized.x << 11 | quantized.y << 5 | quantized.z);
+}
+
+//------------------------------------------------------------------------------
+static glm::vec3 UnpackRGB(uint32_t color)
+{
+	return glm::vec3(static_cast<float>(color >> 24), static_cast<float>((color >> 16) & 0xFF), static_cast<float>((color >> 8) & 0xFF));
+}
+
+//------------------------------------------------------------------------------
+// Encodes 16 texels in row order. The endpoints are the extremes of the opaque colors along their principal
+// axis, every texel takes the nearest of the colors the endpoints decode to. Texels with alpha below one half
+// switch the block to three color mode and become transparent black.
+static void EncodeBC1Block(const uint32_t (&texels)[kTextureTileTexels], uint8_t* block)
+{
+	glm::vec3 mean(0.0f);
+	size_t opaqueCount = 0;
+	for (uint32_t texel : texels)
+	{
+		if ((texel & 0xFF) >= 128)
+		{
+			mean += UnpackRGB(texel);
+			opaqueCount++;
+		}
+	}
+
+	const bool hasTransparent = opaqueCount < kTextureTileTexels;
+	uint16_t endpoint0 = 0;
+	uint16_t endpoint1 = 0;
+
+	if (opaqueCount > 0)
+	{
+		mean /= static_cast<float>(opaqueCount);
+
+		glm::mat3 covariance(0.0f);
+		for (uint32_t texel : texels)
+		{
+			if ((texel & 0xFF) >= 128)
+			{
+				const glm::vec3 offset = UnpackRGB(texel) - mean;
+				covariance += glm::outerProduct(offset, offset);
+			}
+		}
+
+		// Power iteration, a few steps are enough to separate the dominant axis of 16 colors
+		glm::vec3 axis(1.0f);
+		for (int32_t i = 0; i < 8; i++)
+		{
+			const glm::vec3 next = covariance * axis;
+			const float length = glm::length(next);
+			if (length < 1e-4f)
+			{
+				break;
+			}
+			axis = next / length;
+		}
+
+		float minProjection = std::numeric_limits<float>::max();
+		float maxProjection = std::numeric_limits<float>::lowest();
+		for (uint32_t texel : texels)
+		{
+			if ((texel & 0xFF) >= 128)
+			{
+				const float projection = glm::dot(UnpackRGB(texel) - mean, axis);
+				minProjection = std::min(minProjection, projection);
+				maxProjection = std::max(maxProjection, projection);
+			}
+		}
+
+		endpoint0 = EncodeRGB565(mean + axis * maxProjection);
+		endpoint1 = EncodeRGB565(mean + axis * minProjection);
+	}
+
+	// The endpoint order selects the mode
+	if (hasTransparent ? endpoint0 > endpoint1 : endpoint0 < endpoint1)
+	{
+		std::swap(endpoint0, endpoint1);
+	}
+
+	block[0] = static_cast<uint8_t>(endpoint0);
+	block[1] = static_cast<uint8_t>(endpoint0 >> 8);
+	block[2] = static_cast<uint8_t>(endpoint1);
+	block[3] = static_cast<uint8_t>(endpoint1 >> 8);
+
+	// Decode the candidate colors with the sampler's own decoder, selectors 0 to 3 in the first row
+	block[4] = 0xE4;
+	uint32_t colors[4];
+	for (int32_t i = 0; i < 4; i++)
+	{
+		colors[i] = Texture::DecodeBC1Texel(block, i, 0);
+	}
+
+	// Equal endpoints decode to one color in either mode, interpolating between them would change nothing
+	const uint32_t colorCount = hasTransparent ? 3 : (endpoint0 == endpoint1 ? 1 : 4);
+	for (int32_t y = 0; y < kTextureTileSize; y++)
+	{
+		uint8_t row = 0;
+		for (int32_t x = 0; x < kTextureTileSize; x++)
+		{
+			const uint32_t texel = texels[y * kTextureTileSize + x];
+
+			uint32_t selector = 3;
+			if ((texel & 0xFF) >= 128)
+			{
+				selector = 0;
+				for (uint32_t i = 1; i < colorCount; i++)
+				{
+					if (ColorDistance(colors[i] | 0xFF, texel | 0xFF) < ColorDistance(colors[selector] | 0xFF, texel | 0xFF))
+					{
+						selector = i;
+					}
+				}
+			}
+			row |= static_cast<uint8_t>(selector << (2 * x));
+		}
+		block[4 + y] = row;
+	}
+}
+
+//------------------------------------------------------------------------------
+Texture::Texture() = default;
+
+//------------------------------------------------------------------------------
+Texture::Texture(const fs::path& filepath, TextureLayout layout, TextureFormat format)
+	: mLayout(layout)
+	, mFormat(format)
+{
+	glm::ivec2 size = { 0, 0 };
+	std::vector<uint32_t> pixels = LoadPNGToRGBA(filepath, size.x, size.y);
+
+	// A texture that failed to load is a single black texel, so sampling never needs to check
+	if (pixels.empty())
+	{
+		size = { 1, 1 };
+		pixels.push_back(0x000000FF);
+	}
+
+	Build(std::move(pixels), size);
+
+	if (format == TextureFormat::P8 && mFormat != TextureFormat::P8)
+	{
+		std::cerr << "Texture has more than " << kTexturePaletteSize << " colors, storing it as RGBA8: " << filepath << std::endl;
+	}
+}
+
+//------------------------------------------------------------------------------
+Texture::Texture(std::vector<uint32_t> pixels, const glm::ivec2& size, TextureLayout layout, TextureFormat format)
+	: mLayout(layout)
+	, mFormat(format)
+{
+	assert(!pixels.empty() && pixels.size() == static_cast<size_t>(size.x) * size.y && "Error: Pixel count does not match the texture size!");
+	Build(std::move(pixels), size);
+}
+
+//------------------------------------------------------------------------------
+void Texture::Build(std::vector<uint32_t> pixels, glm::ivec2 size)
+{
+	if (mFormat == TextureFormat::P8 && !BuildPalette(pixels, mPalette))
+	{
+		mPalette.clear();
+		mFormat = TextureFormat::RGBA8;
+	}
+
+	// BC1 blocks are tiles
+	if (mFormat == TextureFormat::BC1)
+	{
+		mLayout = TextureLayout::Tiled;
+	}
+
+	// Reserve the whole chain up front, adding the levels never reallocates
+	size_t blockCount = 0;
+	for (glm::ivec2 levelSize = size;; levelSize = glm::max(levelSize / 2, glm::ivec2(1)))
+	{
+		blockCount += (GetLevelSizeInBytes(levelSize, mLayout, mFormat) + sizeof(TexelBlock) - 1) / sizeof(TexelBlock);
+
+		if (levelSize.x == 1 && levelSize.y == 1)
+		{
+			break;
+		}
+	}
+	mStorage.reserve(blockCount);
+
+	StoreLevel(pixels, size);
+	while (size.x > 1 || size.y > 1)
+	{
+		const glm::ivec2 nextSize = glm::max(size / 2, glm::ivec2(1));
+		pixels = GenerateMipLevel(pixels, size, nextSize);
+		size = nextSize;
+		StoreLevel(pixels, size);
+	}
+}
+
+//------------------------------------------------------------------------------
+Texture::~Texture() = default;
+
+//------------------------------------------------------------------------------
+void Texture::View(std::unique_ptr<MappedFile> storage, const uint8_t* data, size_t dataSize, TextureLayout layout, TextureFormat format,
+				   std::vector<TextureLevel> levels, std::vector<uint32_t> palette)
+{
+	mStorage.clear();
+	mMappedStorage = std::move(storage);
+	mData = data;
+	mDataSize = dataSize;
+	mLevels = std::move(levels);
+	mPalette = std::move(palette);
+	mLayout = layout;
+	mFormat = format;
+}
+
+//------------------------------------------------------------------------------
+size_t Texture::GetLevelSizeInBytes(const glm::ivec2& size, TextureLayout layout, TextureFormat format)
+{
+	const size_t tileCount = static_cast<size_t>((size.x + kTextureTileMask) >> kTextureTileShift) * ((size.y + kTextureTileMask) >> kTextureTileShift);
+	switch (format)
+	{
+		case TextureFormat::BC1:
+			return tileCount * kBC1BlockSize;
+		case TextureFormat::L8:
+		case TextureFormat::P8:
+			// The tiled layout pads every level to whole tiles
+			return layout == TextureLayout::Tiled ? tileCount * kTextureTileTexels : static_cast<size_t>(size.x) * size.y;
+		default:
+			return (layout == TextureLayout::Tiled ? tileCount * kTextureTileTexels : static_cast<size_t>(size.x) * size.y) * sizeof(uint32_t);
+	}
+}
+
+//------------------------------------------------------------------------------
+void Texture::StoreLevel(const std::vector<uint32_t>& pixels, const glm::ivec2& size)
+{
+	TextureLevel level;
+	level.mSize = size;
+	level.mOffset = mStorage.size() * sizeof(TexelBlock);
+	level.mTileCountX = (size.x + kTextureTileMask) >> kTextureTileShift;
+
+	// Every level is padded to a whole block
+	mStorage.resize(mStorage.size() + (GetLevelSizeInBytes(size, mLayout, mFormat) + sizeof(TexelBlock) - 1) / sizeof(TexelBlock), TexelBlock { });
+	mData = mStorage.data()->mBytes;
+	mDataSize = mStorage.size() * sizeof(TexelBlock);
+
+	uint8_t* data = mStorage.data()->mBytes + level.mOffset;
+	if (mFormat == TextureFormat::BC1)
+	{
+		// Blocks over the edge of a level repeat its last row and column
+		for (int32_t blockY = 0; blockY < size.y; blockY += kTextureTileSize)
+		{
+			for (int32_t blockX = 0; blockX < size.x; blockX += kTextureTileSize)
+			{
+				uint32_t texels[kTextureTileTexels];
+				for (int32_t y = 0; y < kTextureTileSize; y++)
+				{
+					for (int32_t x = 0; x < kTextureTileSize; x++)
+					{
+						const int32_t sourceX = std::min(blockX + x, size.x - 1);
+						const int32_t sourceY = std::min(blockY + y, size.y - 1);
+						texels[y * kTextureTileSize + x] = pixels[sourceY * size.x + sourceX];
+					}
+				}
+
+				const size_t block = static_cast<size_t>(blockY >> kTextureTileShift) * level.mTileCountX + (blockX >> kTextureTileShift);
+				EncodeBC1Block(texels, data + block * kBC1BlockSize);
+			}
+		}
+	}
+	else
+	{
+		// Mip levels of palette art blend new colors, each maps to the nearest entry once
+		std::unordered_map<uint32_t, uint8_t> paletteEntries;
+
+		for (int32_t y = 0; y < size.y; y++)
+		{
+			for (int32_t x = 0; x < size.x; x++)
+			{
+				const uint32_t pixel = pixels[y * size.x + x];
+				const size_t index = mLayout == TextureLayout::Tiled ? GetTexelIndex<TextureLayout::Tiled>(level, x, y)
+																	 : GetTexelIndex<TextureLayout::Linear>(level, x, y);
+
+				if (mFormat == TextureFormat::L8)
+				{
+					data[index] = static_cast<uint8_t>(pixel >> 24);
+				}
+				else if (mFormat == TextureFormat::P8)
+				{
+					auto entry = paletteEntries.find(pixel);
+					if (entry == paletteEntries.end())
+					{
+						entry = paletteEntries.emplace(pixel, FindNearestPaletteEntry(mPalette, pixel)).first;
+					}
+					data[index] = entry->second;
+				}
+				else
+				{
+					std::memcpy(data + index * sizeof(uint32_t), &pixel, sizeof(pixel));
+				}
+			}
+		}
+	}
+
+	mLevels.push_back(level);
+}
\ No newline at end of file
@@ -9,31 +9,251 @@
 #include <glm/glm.hpp>
 
 // System
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
+#include <memory>
+#include <vector>
+
+// Forward Declarations
+//------------------------------------------------------------------------------
+class MappedFile;
 
 // Type Alias
 //------------------------------------------------------------------------------
 namespace fs = std::filesystem;
 
+// Constants
+//------------------------------------------------------------------------------
+constexpr int32_t kTextureTileShift = 2;
+constexpr int32_t kTextureTileSize = 1 << kTextureTileShift;
+constexpr int32_t kTextureTileMask = kTextureTileSize - 1;
+constexpr size_t kTextureTileTexels = kTextureTileSize * kTextureTileSize;
+constexpr size_t kTexturePaletteSize = 256;
+constexpr size_t kBC1BlockSize = 8;  // Bytes per 4x4 block
+
+//------------------------------------------------------------------------------
+enum class TextureLayout : uint8_t
+{
+	Linear,  // Rows of texels
+	Tiled    // Rows of 4x4 texel tiles, the 16 texels of a tile fill one 64 byte cache line
+};
+
+//------------------------------------------------------------------------------
+// How texels are stored, every format is decoded to RGBA8888 when a texel is fetched
+enum class TextureFormat : uint8_t
+{
+	RGBA8,     // 32 bits per texel
+	L8,        // 8-bit luminance, opaque
+	P8,        // 8-bit index into a palette of up to 256 colors
+	BC1        // 4 bits per texel, 4x4 blocks of two RGB565 endpoints and 2-bit indices, 1-bit alpha
+};
+
+//------------------------------------------------------------------------------
+// How texel coordinates outside of the texture are mapped back into it
+enum class TextureAddressMode : uint8_t
+{
+	Wrap,    // Repeats the texture
+	Clamp,   // Repeats the edge texels
+	Mirror   // Repeats the texture, flipping every other copy
+};
+
+//------------------------------------------------------------------------------
+enum class TextureFilter : uint8_t
+{
+	Nearest,
+	Bilinear  // Weighted average of the 2x2 texels around the sample
+};
+
+//------------------------------------------------------------------------------
+// Sampling settings of a texture, see TextureSampler.h
+struct SamplerState
+{
+	TextureAddressMode mAddressMode = TextureAddressMode::Wrap;
+	TextureFilter mFilter = TextureFilter::Nearest;
+};
+
+//------------------------------------------------------------------------------
+// Dimensions of one mip level and where its texels start in the texture data
+struct TextureLevel
+{
+	glm::ivec2 mSize;
+	size_t mOffset;       // In bytes
+	int32_t mTileCountX;  // Tiles per row in the tiled layout and blocks per row in BC1
+};
+
+/*
+	Texture with a full mip chain, stored in any of the texel formats and decoded to RGBA8888
+	when a texel is fetched. Every level halves the size of the previous one down to 1x1 and is
+	box filtered from it at load time, so minified triangles can sample a level whose texels are
+	about the size of a pixel instead of skipping across the base level.
+
+	In the tiled layout the texels a rotated or vertical walk through texture space touches
+	next are mostly in the same cache line, in the linear layout only horizontal walks are.
+	Every level starts on a cache line, so tiles never straddle two lines.
+
+	The smaller formats trade a few decode instructions per fetch for 4x (L8, P8) or 8x (BC1)
+	less memory and cache footprint than RGBA8. BC1 blocks are always stored in tile order,
+	one 4x4 block per tile, whatever layout was requested. A P8 texture of art with more
+	than 256 colors falls back to RGBA8, mip levels map their filtered colors to the nearest
+	palette entry. L8 keeps the red channel, it is meant for grayscale art.
+
+	Texels are fetched and decoded by the samplers, see TextureSampler.h. A texture either owns
+	its texels or views a memory-mapped texture cache in place, see TextureCache.h.
+*/
 //------------------------------------------------------------------------------
 class Texture
 {
 public:
-	Texture(const fs::path& filepath)
-		: mData(LoadPNGToRGBA(filepath, mSize.x, mSize.y))
-	{ }
+	Texture();
+	Texture(const fs::path& filepath, TextureLayout layout = TextureLayout::Linear, TextureFormat format = TextureFormat::RGBA8);
+
+	// Rows of RGBA8888 pixels, bottom row first like a loaded PNG
+	Texture(std::vector<uint32_t> pixels, const glm::ivec2& size, TextureLayout layout = TextureLayout::Linear,
+			TextureFormat format = TextureFormat::RGBA8);
+	~Texture();
+
+	// Delete copy and assignment, the texel pointer would still point into the source
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
+	// Views levels that live in storage without copying them, the texture keeps storage alive.
+	// Level offsets are relative to data, which must be aligned to a cache line.
+	void View(std::unique_ptr<MappedFile> storage, const uint8_t* data, size_t dataSize, TextureLayout layout, TextureFormat format,
+			  std::vector<TextureLevel> levels, std::vector<uint32_t> palette);
+
+	const glm::ivec2& GetSize(size_t level = 0) const
+	{
+		return mLevels[level].mSize;
+	}
+
+	const TextureLevel& GetLevel(size_t level) const
+	{
+		return mLevels[level];
+	}
+
+	size_t GetLevelCount() const
+	{
+		return mLevels.size();
+	}
 
-	const glm::ivec2& GetSize() const
+	TextureLayout GetLayout() const
 	{
-		return mSize;
+		return mLayout;
 	}
 
-	uint32_t GetPixel(int x, int y) const
+	TextureFormat GetFormat() const
 	{
-		return mData[y * mSize.x + x];
+		return mFormat;
+	}
+
+	// Texels of all levels, each level padded to a whole cache line
+	const uint8_t* GetData() const
+	{
+		return mData;
+	}
+
+	size_t GetDataSize() const
+	{
+		return mDataSize;
+	}
+
+	const std::vector<uint32_t>& GetPalette() const
+	{
+		return mPalette;
+	}
+
+	// Memory held by the texels of all levels and the palette
+	size_t GetSizeInBytes() const
+	{
+		return mDataSize + mPalette.size() * sizeof(uint32_t);
+	}
+
+	// Bytes of a level before padding
+	static size_t GetLevelSizeInBytes(const glm::ivec2& size, TextureLayout layout, TextureFormat format);
+
+	// Both dimensions are powers of two, then so are the dimensions of every mip level
+	bool IsPowerOfTwo() const
+	{
+		const glm::ivec2& size = mLevels[0].mSize;
+		return (size.x & (size.x - 1)) == 0 && (size.y & (size.y - 1)) == 0;
+	}
+
+	const SamplerState& GetSampler() const
+	{
+		return mSampler;
+	}
+
+	void SetSampler(const SamplerState& sampler)
+	{
+		mSampler = sampler;
+	}
+
+	static uint32_t DecodeLuminance(uint8_t luminance)
+	{
+		return luminance * 0x01010100u | 0xFFu;
+	}
+
+	// Expands a RGB565 color to opaque RGBA8888, replicating the high bits into the low ones
+	static uint32_t DecodeRGB565(uint16_t color)
+	{
+		const uint32_t r = (color >> 11) & 0x1F;
+		const uint32_t g = (color >> 5) & 0x3F;
+		const uint32_t b = color & 0x1F;
+		return ((r << 3 | r >> 2) << 24) | ((g << 2 | g >> 4) << 16) | ((b << 3 | b >> 2) << 8) | 0xFF;
+	}
+
+	// Decodes only the texel at (x, y) of a block. The first endpoint being the larger one selects two
+	// interpolated colors, otherwise one midpoint and transparent black.
+	static uint32_t DecodeBC1Texel(const uint8_t* block, int x, int y)
+	{
+		const uint16_t endpoint0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+		const uint16_t endpoint1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+		const uint32_t selector = (block[4 + y] >> (2 * x)) & 0x3;
+
+		if (selector < 2)
+		{
+			return DecodeRGB565(selector == 0 ? endpoint0 : endpoint1);
+		}
+		if (endpoint0 <= endpoint1 && selector == 3)
+		{
+			return 0;
+		}
+
+		// 2/3 c0 + 1/3 c1 for selector 2 and the reverse for 3 in four color mode, (c0 + c1) / 2 in three color mode
+		const uint32_t color0 = DecodeRGB565(endpoint0);
+		const uint32_t color1 = DecodeRGB565(endpoint1);
+		const uint32_t weight0 = endpoint0 > endpoint1 ? (selector == 2 ? 2 : 1) : 1;
+		const uint32_t weight1 = endpoint0 > endpoint1 ? 3 - weight0 : 1;
+		const uint32_t divisor = weight0 + weight1;
+
+		uint32_t color = 0xFF;
+		for (uint32_t shift = 8; shift < 32; shift += 8)
+		{
+			const uint32_t channel = (((color0 >> shift) & 0xFF) * weight0 + ((color1 >> shift) & 0xFF) * weight1) / divisor;
+			color |= channel << shift;
+		}
+		return color;
 	}
 
 private:
-	std::vector<uint32_t> mData;
-	glm::ivec2 mSize;
+	// Generates the mip chain of the base level and stores every level in the texture's format
+	void Build(std::vector<uint32_t> pixels, glm::ivec2 size);
+	void StoreLevel(const std::vector<uint32_t>& pixels, const glm::ivec2& size);
+
+	// Storage unit aligned to a cache line, level offsets are rounded up to whole blocks
+	struct alignas(64) TexelBlock
+	{
+		uint8_t mBytes[64];
+	};
+
+	std::vector<TexelBlock> mStorage;
+	std::unique_ptr<MappedFile> mMappedStorage;
+	const uint8_t* mData = nullptr;
+	size_t mDataSize = 0;
+	std::vector<TextureLevel> mLevels;
+	std::vector<uint32_t> mPalette;
+	TextureLayout mLayout = TextureLayout::Linear;
+	TextureFormat mFormat = TextureFormat::RGBA8;
+	SamplerState mSampler;
 };
\ No newline at end of file
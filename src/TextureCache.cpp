@@ -0,0 +1,260 @@
+#include "TextureCache.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "CacheFile.h"
+
+// Core
+#include "Core/MappedFile.h"
+
+// System
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+static constexpr std::array<char, 4> kTextureCacheMagic = { 'T', 'E', 'X', 'C' };
+static constexpr uint32_t kTextureCacheVersion = 1;
+static constexpr uint32_t kTextureCacheByteOrder = 0x01020304;  // Reads back differently on a host of the other endianness
+static constexpr uint32_t kMaxTextureCacheLevels = 32;          // Enough for any size that fits an int32_t
+
+//------------------------------------------------------------------------------
+struct TextureCacheHeader
+{
+    std::array<char, 4> mMagic;
+    uint32_t mVersion;
+    uint32_t mByteOrder;
+    uint32_t mLayout;
+    uint32_t mFormat;
+    uint32_t mLevelCount;
+    uint32_t mPaletteSize;
+    uint32_t mReserved;
+    uint64_t mFileSize;
+    uint64_t mSourceSize;
+    int64_t mSourceWriteTime;
+
+    uint64_t mLevelsOffset;
+    uint64_t mPaletteOffset;
+    uint64_t mDataOffset;
+    uint64_t mDataSize;
+};
+
+//------------------------------------------------------------------------------
+struct TextureCacheLevel
+{
+    int32_t mWidth;
+    int32_t mHeight;
+    uint64_t mOffset;  // Relative to the texel block
+};
+
+//------------------------------------------------------------------------------
+static const char* GetTextureLayoutName(TextureLayout layout)
+{
+    return layout == TextureLayout::Tiled ? "tiled" : "linear";
+}
+
+//------------------------------------------------------------------------------
+static const char* GetTextureFormatName(TextureFormat format)
+{
+    switch (format)
+    {
+        case TextureFormat::L8:  return "l8";
+        case TextureFormat::P8:  return "p8";
+        case TextureFormat::BC1: return "bc1";
+        default:                 return "rgba8";
+    }
+}
+
+//------------------------------------------------------------------------------
+// The chain halves down to 1x1 and every level lies inside the texel block, sampling relies on both
+static bool AreCacheLevelsValid(const std::vector<TextureLevel>& levels, TextureLayout layout, TextureFormat format, uint64_t dataSize)
+{
+    glm::ivec2 expectedSize = levels.front().mSize;
+    if (expectedSize.x <= 0 || expectedSize.y <= 0)
+    {
+        return false;
+    }
+
+    for (const TextureLevel& level : levels)
+    {
+        if (level.mSize != expectedSize || level.mOffset % kCacheFileAlignment != 0 || level.mOffset > dataSize ||
+            Texture::GetLevelSizeInBytes(level.mSize, layout, format) > dataSize - level.mOffset)
+        {
+            return false;
+        }
+        expectedSize = glm::max(expectedSize / 2, glm::ivec2(1));
+    }
+
+    return levels.back().mSize == glm::ivec2(1);
+}
+
+//------------------------------------------------------------------------------
+fs::path GetTextureCachePath(const fs::path& sourcePath, TextureLayout layout, TextureFormat format)
+{
+    fs::path cachePath = sourcePath;
+    cachePath += ".";
+    cachePath += GetTextureLayoutName(layout);
+    cachePath += ".";
+    cachePath += GetTextureFormatName(format);
+    cachePath += ".texcache";
+    return cachePath;
+}
+
+//------------------------------------------------------------------------------
+bool WriteTextureCache(const Texture& texture, const fs::path& cachePath, const fs::path& sourcePath)
+{
+    CacheFileSource source;
+    if (!QueryCacheFileSource(sourcePath, source))
+    {
+        return false;
+    }
+
+    std::vector<TextureCacheLevel> levels(texture.GetLevelCount());
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        const TextureLevel& level = texture.GetLevel(i);
+        levels[i] = { level.mSize.x, level.mSize.y, level.mOffset };
+    }
+
+    const std::vector<uint32_t>& palette = texture.GetPalette();
+
+    TextureCacheHeader header { };
+    header.mMagic = kTextureCacheMagic;
+    header.mVersion = kTextureCacheVersion;
+    header.mByteOrder = kTextureCacheByteOrder;
+    header.mLayout = static_cast<uint32_t>(texture.GetLayout());
+    header.mFormat = static_cast<uint32_t>(texture.GetFormat());
+    header.mLevelCount = static_cast<uint32_t>(levels.size());
+    header.mPaletteSize = static_cast<uint32_t>(palette.size());
+    header.mSourceSize = source.mSize;
+    header.mSourceWriteTime = source.mWriteTime;
+
+    header.mLevelsOffset = AlignCacheOffset(sizeof(TextureCacheHeader));
+    header.mPaletteOffset = AlignCacheOffset(header.mLevelsOffset + levels.size() * sizeof(TextureCacheLevel));
+    header.mDataOffset = AlignCacheOffset(header.mPaletteOffset + palette.size() * sizeof(uint32_t));
+    header.mDataSize = texture.GetDataSize();
+    header.mFileSize = header.mDataOffset + header.mDataSize;
+
+    // Write to a temporary file first, readers never see a partially written cache
+    fs::path temporaryPath = cachePath;
+    temporaryPath += ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WriteCachePadding(file, sizeof(header));
+        file.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(TextureCacheLevel));
+        WriteCachePadding(file, header.mLevelsOffset + levels.size() * sizeof(TextureCacheLevel));
+        file.write(reinterpret_cast<const char*>(palette.data()), palette.size() * sizeof(uint32_t));
+        WriteCachePadding(file, header.mPaletteOffset + palette.size() * sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(texture.GetData()), texture.GetDataSize());
+
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporaryPath, cachePath, error);
+    return !error;
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<Texture> LoadTextureCache(const fs::path& cachePath, const fs::path& sourcePath)
+{
+    std::error_code error;
+    if (!fs::exists(cachePath, error))
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>(cachePath);
+    if (!file->IsValid() || file->GetContents().size() < sizeof(TextureCacheHeader))
+    {
+        return nullptr;
+    }
+
+    const char* data = file->GetContents().data();
+    TextureCacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.mMagic != kTextureCacheMagic || header.mVersion != kTextureCacheVersion || header.mByteOrder != kTextureCacheByteOrder ||
+        header.mLayout > static_cast<uint32_t>(TextureLayout::Tiled) || header.mFormat > static_cast<uint32_t>(TextureFormat::BC1) ||
+        header.mLevelCount == 0 || header.mLevelCount > kMaxTextureCacheLevels || header.mPaletteSize > kTexturePaletteSize ||
+        (header.mFormat == static_cast<uint32_t>(TextureFormat::P8)) != (header.mPaletteSize != 0) ||
+        header.mFileSize != file->GetContents().size())
+    {
+        return nullptr;
+    }
+
+    // A cache without its source is still usable, a changed source makes it stale
+    CacheFileSource source;
+    if (QueryCacheFileSource(sourcePath, source) && (source.mSize != header.mSourceSize || source.mWriteTime != header.mSourceWriteTime))
+    {
+        return nullptr;
+    }
+
+    if (!IsCacheBlockValid(header.mLevelsOffset, header.mLevelCount * sizeof(TextureCacheLevel), sizeof(TextureCacheHeader), header.mFileSize) ||
+        !IsCacheBlockValid(header.mPaletteOffset, header.mPaletteSize * sizeof(uint32_t), sizeof(TextureCacheHeader), header.mFileSize) ||
+        !IsCacheBlockValid(header.mDataOffset, header.mDataSize, sizeof(TextureCacheHeader), header.mFileSize))
+    {
+        return nullptr;
+    }
+
+    const TextureLayout layout = static_cast<TextureLayout>(header.mLayout);
+    const TextureFormat format = static_cast<TextureFormat>(header.mFormat);
+
+    std::vector<TextureLevel> levels(header.mLevelCount);
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        TextureCacheLevel cacheLevel;
+        std::memcpy(&cacheLevel, data + header.mLevelsOffset + i * sizeof(TextureCacheLevel), sizeof(cacheLevel));
+        levels[i].mSize = { cacheLevel.mWidth, cacheLevel.mHeight };
+        levels[i].mOffset = cacheLevel.mOffset;
+        levels[i].mTileCountX = (cacheLevel.mWidth + kTextureTileMask) >> kTextureTileShift;
+    }
+
+    if (!AreCacheLevelsValid(levels, layout, format, header.mDataSize))
+    {
+        return nullptr;
+    }
+
+    // Texels index the palette without bounds checks, entries past the stored ones read as transparent black
+    std::vector<uint32_t> palette;
+    if (format == TextureFormat::P8)
+    {
+        palette.resize(kTexturePaletteSize, 0);
+        std::memcpy(palette.data(), data + header.mPaletteOffset, header.mPaletteSize * sizeof(uint32_t));
+    }
+
+    const uint8_t* texels = reinterpret_cast<const uint8_t*>(data + header.mDataOffset);
+    std::unique_ptr<Texture> texture = std::make_unique<Texture>();
+    texture->View(std::move(file), texels, header.mDataSize, layout, format, std::move(levels), std::move(palette));
+    return texture;
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<Texture> LoadTexture(const fs::path& sourcePath, TextureLayout layout, TextureFormat format)
+{
+    const fs::path cachePath = GetTextureCachePath(sourcePath, layout, format);
+    if (std::unique_ptr<Texture> texture = LoadTextureCache(cachePath, sourcePath))
+    {
+        return texture;
+    }
+
+    std::unique_ptr<Texture> texture = std::make_unique<Texture>(sourcePath, layout, format);
+    if (!WriteTextureCache(*texture, cachePath, sourcePath))
+    {
+        std::cerr << "Warning: Could not write texture cache " << cachePath << std::endl;
+    }
+
+    return texture;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "Texture.h"
+
+// System
+#include <filesystem>
+#include <memory>
+
+// Type Alias
+//------------------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+/*
+    Binary texture cache. The file starts with a versioned header followed by 64 byte aligned
+    blocks for the mip level table, the palette and the texels. The texels are stored in their
+    final format and layout with every level padded to a cache line, exactly as a loaded
+    Texture holds them, so a cached texture views the read-only mapping directly and skips
+    the PNG decode, the mip generation and the encoding.
+
+    Each requested layout and format has its own cache file next to the source. The header
+    records the size and write time of the source file, a cache whose source changed is
+    treated as missing.
+*/
+//------------------------------------------------------------------------------
+fs::path GetTextureCachePath(const fs::path& sourcePath, TextureLayout layout, TextureFormat format);
+bool WriteTextureCache(const Texture& texture, const fs::path& cachePath, const fs::path& sourcePath);
+
+// Returns null when the cache is missing, stale or malformed
+std::unique_ptr<Texture> LoadTextureCache(const fs::path& cachePath, const fs::path& sourcePath);
+
+// Loads the texture from its cache when the cache is up to date, otherwise decodes the PNG file and writes the cache
+std::unique_ptr<Texture> LoadTexture(const fs::path& sourcePath, TextureLayout layout = TextureLayout::Linear,
+                                     TextureFormat format = TextureFormat::RGBA8);
\ No newline at end of file
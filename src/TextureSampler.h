@@ -0,0 +1,212 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "Texture.h"
+
+// Core
+#include "Core/CpuFeatures.h"
+
+// System
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if CPU_SSE2
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+// Addressing specializations. Power-of-two textures wrap and mirror with a mask instead of an integer
+// division, clamping never divides and has no power-of-two variant.
+enum class SamplerVariant : uint8_t
+{
+    Wrap,
+    WrapPowerOfTwo,
+    Clamp,
+    Mirror,
+    MirrorPowerOfTwo,
+    COUNT
+};
+
+constexpr uint32_t kSamplerVariantCount = static_cast<uint32_t>(SamplerVariant::COUNT);
+
+//------------------------------------------------------------------------------
+inline SamplerVariant SelectSamplerVariant(const Texture& texture)
+{
+    const bool isPowerOfTwo = texture.IsPowerOfTwo();
+    switch (texture.GetSampler().mAddressMode)
+    {
+        case TextureAddressMode::Clamp:  return SamplerVariant::Clamp;
+        case TextureAddressMode::Mirror: return isPowerOfTwo ? SamplerVariant::MirrorPowerOfTwo : SamplerVariant::Mirror;
+        default:                         return isPowerOfTwo ? SamplerVariant::WrapPowerOfTwo : SamplerVariant::Wrap;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Floor for coordinates in the int32_t range, without the library call
+inline int32_t FloorToInt(float value)
+{
+    const int32_t truncated = static_cast<int32_t>(value);
+    return truncated - (value < static_cast<float>(truncated) ? 1 : 0);
+}
+
+//------------------------------------------------------------------------------
+// Maps a texel coordinate of any sign into [0, size)
+template<SamplerVariant Variant>
+int32_t AddressTexel(int32_t coordinate, int32_t size)
+{
+    if constexpr (Variant == SamplerVariant::WrapPowerOfTwo)
+    {
+        return coordinate & (size - 1);
+    }
+    else if constexpr (Variant == SamplerVariant::Wrap)
+    {
+        const int32_t wrapped = coordinate % size;
+        return wrapped < 0 ? wrapped + size : wrapped;
+    }
+    else if constexpr (Variant == SamplerVariant::Clamp)
+    {
+        return std::clamp(coordinate, 0, size - 1);
+    }
+    else
+    {
+        // Mirroring repeats with twice the size, the second half runs backwards
+        int32_t mirrored = 0;
+        if constexpr (Variant == SamplerVariant::MirrorPowerOfTwo)
+        {
+            mirrored = coordinate & (2 * size - 1);
+        }
+        else
+        {
+            mirrored = coordinate % (2 * size);
+            mirrored = mirrored < 0 ? mirrored + 2 * size : mirrored;
+        }
+        return mirrored < size ? mirrored : 2 * size - 1 - mirrored;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Index of a texel relative to the start of its level
+template<TextureLayout Layout>
+size_t GetTexelIndex(const TextureLevel& level, int32_t x, int32_t y)
+{
+    if constexpr (Layout == TextureLayout::Tiled)
+    {
+        const size_t tile = static_cast<size_t>(y >> kTextureTileShift) * level.mTileCountX + (x >> kTextureTileShift);
+        return tile * kTextureTileTexels + ((y & kTextureTileMask) << kTextureTileShift) + (x & kTextureTileMask);
+    }
+    else
+    {
+        return static_cast<size_t>(y) * level.mSize.x + x;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Decoded texel at an addressed position of a mip level. BC1 blocks are always tiles, whatever the layout.
+template<TextureFormat Format, TextureLayout Layout>
+uint32_t FetchTexel(const Texture& texture, int32_t x, int32_t y, size_t level)
+{
+    const TextureLevel& textureLevel = texture.GetLevel(level);
+    const uint8_t* data = texture.GetData() + textureLevel.mOffset;
+
+    if constexpr (Format == TextureFormat::L8)
+    {
+        return Texture::DecodeLuminance(data[GetTexelIndex<Layout>(textureLevel, x, y)]);
+    }
+    else if constexpr (Format == TextureFormat::P8)
+    {
+        return texture.GetPalette()[data[GetTexelIndex<Layout>(textureLevel, x, y)]];
+    }
+    else if constexpr (Format == TextureFormat::BC1)
+    {
+        const size_t block = static_cast<size_t>(y >> kTextureTileShift) * textureLevel.mTileCountX + (x >> kTextureTileShift);
+        return Texture::DecodeBC1Texel(data + block * kBC1BlockSize, x & kTextureTileMask, y & kTextureTileMask);
+    }
+    else
+    {
+        uint32_t color;
+        std::memcpy(&color, data + GetTexelIndex<Layout>(textureLevel, x, y) * sizeof(uint32_t), sizeof(color));
+        return color;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Nearest texel of a mip level, texture coordinates span [0, 1] over the level
+template<SamplerVariant Variant, TextureFormat Format, TextureLayout Layout>
+uint32_t SampleNearest(const Texture& texture, float u, float v, size_t level)
+{
+    const glm::ivec2& size = texture.GetSize(level);
+    const int32_t x = AddressTexel<Variant>(FloorToInt(u * static_cast<float>(size.x)), size.x);
+    const int32_t y = AddressTexel<Variant>(FloorToInt(v * static_cast<float>(size.y)), size.y);
+    return FetchTexel<Format, Layout>(texture, x, y, level);
+}
+
+//------------------------------------------------------------------------------
+// Blends four RGBA8888 texels with 8-bit weights, fx and fy in [0, 256) weigh the right column and the bottom
+// row. All four channels are blended at once in 16-bit lanes, a channel times a weight stays below 2^16.
+inline uint32_t BlendBilinear(uint32_t topLeft, uint32_t topRight, uint32_t bottomLeft, uint32_t bottomRight, int32_t fx, int32_t fy)
+{
+#if CPU_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i texels = _mm_setr_epi32(static_cast<int32_t>(topLeft), static_cast<int32_t>(topRight),
+                                          static_cast<int32_t>(bottomLeft), static_cast<int32_t>(bottomRight));
+
+    // Horizontal pass, the left texel of a row is in the low and the right texel in the high 64 bits
+    const __m128i weightX = _mm_setr_epi16(static_cast<int16_t>(256 - fx), static_cast<int16_t>(256 - fx), static_cast<int16_t>(256 - fx),
+                                           static_cast<int16_t>(256 - fx), static_cast<int16_t>(fx), static_cast<int16_t>(fx),
+                                           static_cast<int16_t>(fx), static_cast<int16_t>(fx));
+    const __m128i top = _mm_mullo_epi16(_mm_unpacklo_epi8(texels, zero), weightX);
+    const __m128i bottom = _mm_mullo_epi16(_mm_unpackhi_epi8(texels, zero), weightX);
+    const __m128i topRow = _mm_add_epi16(top, _mm_shuffle_epi32(top, _MM_SHUFFLE(1, 0, 3, 2)));
+    const __m128i bottomRow = _mm_add_epi16(bottom, _mm_shuffle_epi32(bottom, _MM_SHUFFLE(1, 0, 3, 2)));
+    const __m128i rows = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(topRow, bottomRow), round), 8);
+
+    // Vertical pass between the top row in the low and the bottom row in the high 64 bits
+    const __m128i weightY = _mm_setr_epi16(static_cast<int16_t>(256 - fy), static_cast<int16_t>(256 - fy), static_cast<int16_t>(256 - fy),
+                                           static_cast<int16_t>(256 - fy), static_cast<int16_t>(fy), static_cast<int16_t>(fy),
+                                           static_cast<int16_t>(fy), static_cast<int16_t>(fy));
+    const __m128i weighted = _mm_mullo_epi16(rows, weightY);
+    const __m128i blended = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(weighted, _mm_shuffle_epi32(weighted, _MM_SHUFFLE(1, 0, 3, 2))), round), 8);
+
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(blended, blended)));
+#else
+    // Same arithmetic per channel, the results match the vectorized path
+    uint32_t color = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8)
+    {
+        const uint32_t weightX = static_cast<uint32_t>(fx);
+        const uint32_t weightY = static_cast<uint32_t>(fy);
+        const uint32_t top = (((topLeft >> shift) & 0xFF) * (256 - weightX) + ((topRight >> shift) & 0xFF) * weightX + 128) >> 8;
+        const uint32_t bottom = (((bottomLeft >> shift) & 0xFF) * (256 - weightX) + ((bottomRight >> shift) & 0xFF) * weightX + 128) >> 8;
+        color |= ((top * (256 - weightY) + bottom * weightY + 128) >> 8) << shift;
+    }
+    return color;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Bilinear sample of a mip level. Texel centers are at half-integer coordinates, the footprint is the 2x2
+// block of texel centers around the sample, each addressed on its own so edges wrap, clamp or mirror.
+template<SamplerVariant Variant, TextureFormat Format, TextureLayout Layout>
+uint32_t SampleBilinear(const Texture& texture, float u, float v, size_t level)
+{
+    const glm::ivec2& size = texture.GetSize(level);
+    const float x = u * static_cast<float>(size.x) - 0.5f;
+    const float y = v * static_cast<float>(size.y) - 0.5f;
+    const int32_t x0 = FloorToInt(x);
+    const int32_t y0 = FloorToInt(y);
+
+    const int32_t fx = static_cast<int32_t>((x - static_cast<float>(x0)) * 256.0f);
+    const int32_t fy = static_cast<int32_t>((y - static_cast<float>(y0)) * 256.0f);
+
+    const int32_t left = AddressTexel<Variant>(x0, size.x);
+    const int32_t right = AddressTexel<Variant>(x0 + 1, size.x);
+    const int32_t top = AddressTexel<Variant>(y0, size.y);
+    const int32_t bottom = AddressTexel<Variant>(y0 + 1, size.y);
+
+    return BlendBilinear(FetchTexel<Format, Layout>(texture, left, top, level), FetchTexel<Format, Layout>(texture, right, top, level),
+                         FetchTexel<Format, Layout>(texture, left, bottom, level), FetchTexel<Format, Layout>(texture, right, bottom, level), fx, fy);
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "TileRasterizer.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "ColorBuffer.h"
+#include "ZBuffer.h"
+#include "Texture.h"
+
+// Core
+#include "Core/JobSystem.h"
+
+// System
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+TileRasterizer::TileRasterizer(const glm::ivec2& viewportSize, JobSystem& jobSystem)
+    : mJobSystem(jobSystem)
+    , mViewportSize(viewportSize)
+    , mTileCount((viewportSize + (kTileSize - 1)) / kTileSize)
+{
+    mTiles.resize(mTileCount.x * mTileCount.y);
+
+    for (int32_t tileY = 0; tileY < mTileCount.y; tileY++)
+    {
+        for (int32_t tileX = 0; tileX < mTileCount.x; tileX++)
+        {
+            Tile& tile = mTiles[tileY * mTileCount.x + tileX];
+            tile.mBounds.mMinX = tileX * kTileSize;
+            tile.mBounds.mMinY = tileY * kTileSize;
+            tile.mBounds.mMaxX = std::min(tile.mBounds.mMinX + kTileSize, mViewportSize.x);
+            tile.mBounds.mMaxY = std::min(tile.mBounds.mMinY + kTileSize, mViewportSize.y);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void TileRasterizer::DrawTriangles(ColorBuffer& colorBuffer, ZBuffer& zBuffer, const RenderState& renderState, std::span<const Triangle> triangles, const Texture* texture)
+{
+    assert((!renderState.mTextured || texture != nullptr) && "Error: Textured render state requires a texture!");
+
+    // Lines are not binned, they are cheap enough to draw on the calling thread
+    if (renderState.mPolygonMode == PolygonMode::Wireframe)
+    {
+        for (const Triangle& triangle : triangles)
+        {
+            const auto& vertices = triangle.mVertices;
+            DrawWireframeTriangle(colorBuffer, { vertices[0].mPoint, vertices[1].mPoint, vertices[2].mPoint }, renderState.mWireframeColor);
+        }
+        return;
+    }
+
+    BinTriangles(triangles);
+
+    // The rasterizer specialization is selected once for the whole draw
+    mDrawCall = { &colorBuffer, &zBuffer, triangles, texture, renderState, SelectRasterTriangleFunc(renderState, texture) };
+
+    // One job per tile, returns once every tile is done and the buffers can be used
+    mJobSystem.ParallelFor(mTiles.size(), 1, [this](size_t index) { RasterizeTile(mTiles[index]); });
+}
+
+//------------------------------------------------------------------------------
+void TileRasterizer::BinTriangles(std::span<const Triangle> triangles)
+{
+    for (Tile& tile : mTiles)
+    {
+        tile.mTriangleIndices.clear();
+    }
+
+    for (size_t i = 0; i < triangles.size(); i++)
+    {
+        const auto& vertices = triangles[i].mVertices;
+
+        // Screen-space bounding box clamped to the viewport
+        const float minX = std::min({ vertices[0].mPoint.x, vertices[1].mPoint.x, vertices[2].mPoint.x });
+        const float minY = std::min({ vertices[0].mPoint.y, vertices[1].mPoint.y, vertices[2].mPoint.y });
+        const float maxX = std::max({ vertices[0].mPoint.x, vertices[1].mPoint.x, vertices[2].mPoint.x });
+        const float maxY = std::max({ vertices[0].mPoint.y, vertices[1].mPoint.y, vertices[2].mPoint.y });
+
+        const int32_t xMin = std::max(static_cast<int32_t>(std::floor(minX)), 0);
+        const int32_t yMin = std::max(static_cast<int32_t>(std::floor(minY)), 0);
+        const int32_t xMax = std::min(static_cast<int32_t>(std::ceil(maxX)), mViewportSize.x - 1);
+        const int32_t yMax = std::min(static_cast<int32_t>(std::ceil(maxY)), mViewportSize.y - 1);
+
+        if (xMin > xMax || yMin > yMax)
+        {
+            continue;
+        }
+
+        for (int32_t tileY = yMin / kTileSize; tileY <= yMax / kTileSize; tileY++)
+        {
+            for (int32_t tileX = xMin / kTileSize; tileX <= xMax / kTileSize; tileX++)
+            {
+                mTiles[tileY * mTileCount.x + tileX].mTriangleIndices.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void TileRasterizer::RasterizeTile(const Tile& tile)
+{
+    std::span<const Triangle> triangles = mDrawCall.mTriangles;
+
+    for (uint32_t triangleIndex : tile.mTriangleIndices)
+    {
+        mDrawCall.mRasterTriangle(*mDrawCall.mColorBuffer, *mDrawCall.mZBuffer, mDrawCall.mRenderState,
+            triangles[triangleIndex], mDrawCall.mTexture, tile.mBounds);
+    }
+}
\ No newline at end of file
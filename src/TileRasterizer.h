@@ -0,0 +1,67 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "RenderState.h"
+#include "Trangle.h"
+#include "TriangleRasterizer.h"
+
+// Third party
+#include <glm/glm.hpp>
+
+// System
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Forward Declarations
+//------------------------------------------------------------------------------
+class ColorBuffer;
+class JobSystem;
+class Texture;
+class ZBuffer;
+
+/*
+    Sorts screen-space triangles into fixed size tiles and rasterizes the tiles as jobs on the
+    job system, idle threads steal tiles so uneven tiles balance out. Every tile owns a disjoint
+    set of pixels, so the color and depth buffers can be written without any locking. Triangles
+    keep their submission order within a tile.
+*/
+//------------------------------------------------------------------------------
+class TileRasterizer
+{
+public:
+    static constexpr int32_t kTileSize = 64;
+
+    TileRasterizer(const glm::ivec2& viewportSize, JobSystem& jobSystem);
+
+    // The texture may be null when the render state disables texturing
+    void DrawTriangles(ColorBuffer& colorBuffer, ZBuffer& zBuffer, const RenderState& renderState, std::span<const Triangle> triangles, const Texture* texture);
+
+private:
+    struct Tile
+    {
+        ScissorRect mBounds;
+        std::vector<uint32_t> mTriangleIndices;
+    };
+
+    struct DrawCall
+    {
+        ColorBuffer* mColorBuffer = nullptr;
+        ZBuffer* mZBuffer = nullptr;
+        std::span<const Triangle> mTriangles;
+        const Texture* mTexture = nullptr;
+        RenderState mRenderState;
+        RasterTriangleFunc mRasterTriangle = nullptr;
+    };
+
+    void BinTriangles(std::span<const Triangle> triangles);
+    void RasterizeTile(const Tile& tile);
+
+    JobSystem& mJobSystem;
+    glm::ivec2 mViewportSize;
+    glm::ivec2 mTileCount;
+    std::vector<Tile> mTiles;
+    DrawCall mDrawCall;
+};
\ No newline at end of file
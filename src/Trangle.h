@@ -14,6 +14,7 @@ struct Vertex
 	glm::vec4 mPoint;
 	glm::vec3 mNormal;
 	glm::vec2 mUV;
+	float mIntensity = 1.0f;
 };
 
 //------------------------------------------------------------------------------
@@ -6,22 +6,203 @@
 #include "ColorBuffer.h"
 #include "ZBuffer.h"
 #include "Texture.h"
+#include "TextureSampler.h"
 #include "GeometryRenderer.h"
 
+// Core
+#include "Core/CpuFeatures.h"
+
 // Third party
 #include <glm/glm.hpp>
 
 // System
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <utility>
+
+#if CPU_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Fixed point helpers for 28.4 sub-pixel positions
+constexpr int32_t kSubPixelScale = 1 << kSubPixelBits;
+constexpr int32_t kSubPixelMask = kSubPixelScale - 1;
+constexpr int32_t kHalfPixel = kSubPixelScale / 2;
+
+// Size of the square pixel blocks that are classified before any per-pixel work
+constexpr int32_t kBlockSize = 8;
+
+//------------------------------------------------------------------------------
+// Per-pixel features of a rasterizer specialization. The fill rule only changes the edge bias
+// computed once per triangle, so it is read from the render state at runtime instead.
+struct RasterPipeline
+{
+    bool mDepthTest;
+    bool mDepthWrite;
+    bool mTextured;
+    SamplerVariant mSampler;  // Addressing of textured pipelines
+    TextureFilter mFilter;
+    TextureFormat mFormat;
+    TextureLayout mLayout;
+    LightingMode mLighting;
+    BlendMode mBlend;
+
+    constexpr bool UsesDepth() const { return mDepthTest || mDepthWrite; }
+    constexpr bool UsesPerspective() const { return mTextured || mLighting == LightingMode::Smooth; }
+};
+
+constexpr uint32_t kLightingModeCount = 3;
+constexpr uint32_t kBlendModeCount = 2;
+constexpr uint32_t kTextureFilterCount = 2;
+constexpr uint32_t kTextureLayoutCount = 2;
+constexpr uint32_t kTextureFormatCount = 4;
+
+// Every format in either layout, except BC1 whose blocks are always tiles. It is the last format and takes one slot.
+static_assert(static_cast<uint32_t>(TextureFormat::BC1) == kTextureFormatCount - 1);
+constexpr uint32_t kTexelStorageCount = (kTextureFormatCount - 1) * kTextureLayoutCount + 1;
+constexpr uint32_t kTextureModeCount = 1 + kSamplerVariantCount * kTextureFilterCount * kTexelStorageCount;  // Untextured or a sampler variant, filter and texel storage
+constexpr uint32_t kPipelineCount = 2 * 2 * kTextureModeCount * kLightingModeCount * kBlendModeCount;
+
+//------------------------------------------------------------------------------
+uint32_t EncodePipeline(const RenderState& renderState, const Texture* texture)
+{
+    assert((!renderState.mTextured || texture != nullptr) && "Error: Textured render state requires a texture!");
+    uint32_t textureMode = 0;
+    if (renderState.mTextured)
+    {
+        const uint32_t variant = static_cast<uint32_t>(SelectSamplerVariant(*texture));
+        const uint32_t filter = static_cast<uint32_t>(texture->GetSampler().mFilter);
+        const TextureFormat format = texture->GetFormat();
+        const uint32_t layout = format == TextureFormat::BC1 ? 0 : static_cast<uint32_t>(texture->GetLayout());
+        const uint32_t storage = static_cast<uint32_t>(format) * kTextureLayoutCount + layout;
+        textureMode = 1 + (variant * kTextureFilterCount + filter) * kTexelStorageCount + storage;
+    }
+
+    uint32_t key = static_cast<uint32_t>(renderState.mBlend);
+    key = key * kLightingModeCount + static_cast<uint32_t>(renderState.mLighting);
+    key = key * kTextureModeCount + textureMode;
+    key = key * 2 + (renderState.mDepthWrite ? 1 : 0);
+    key = key * 2 + (renderState.mDepthTest ? 1 : 0);
+    return key;
+}
+
+//------------------------------------------------------------------------------
+constexpr RasterPipeline DecodePipeline(uint32_t key)
+{
+    RasterPipeline pipeline { };
+    pipeline.mDepthTest = (key % 2) != 0;
+    key /= 2;
+    pipeline.mDepthWrite = (key % 2) != 0;
+    key /= 2;
+    const uint32_t textureMode = key % kTextureModeCount;
+    pipeline.mTextured = textureMode != 0;
+    const uint32_t sampler = pipeline.mTextured ? textureMode - 1 : 0;
+    const uint32_t storage = sampler % kTexelStorageCount;
+    pipeline.mFormat = static_cast<TextureFormat>(storage / kTextureLayoutCount);
+    pipeline.mLayout = static_cast<TextureLayout>(storage % kTextureLayoutCount);
+    pipeline.mFilter = static_cast<TextureFilter>((sampler / kTexelStorageCount) % kTextureFilterCount);
+    pipeline.mSampler = static_cast<SamplerVariant>(sampler / kTexelStorageCount / kTextureFilterCount);
+    key /= kTextureModeCount;
+    pipeline.mLighting = static_cast<LightingMode>(key % kLightingModeCount);
+    key /= kLightingModeCount;
+    pipeline.mBlend = static_cast<BlendMode>(key % kBlendModeCount);
+    return pipeline;
+}
+
+//------------------------------------------------------------------------------
+// Screen-space plane equation of an interpolated attribute
+struct AttributePlane
+{
+    float mOrigin;  // Value at the center of the plane origin pixel
+    float mStepX;   // Change per pixel in X
+    float mStepY;   // Change per pixel in Y
+
+    float At(int32_t offsetX, int32_t offsetY) const { return mOrigin + offsetX * mStepX + offsetY * mStepY; }
+};
+
+//------------------------------------------------------------------------------
+// Everything the raster loop needs, computed once per triangle
+struct TriangleSetup
+{
+    // Pixel bounds restricted to the scissor region (maximum is exclusive)
+    int32_t mXMin;
+    int32_t mYMin;
+    int32_t mXMax;
+    int32_t mYMax;
+
+    // Fill rule biased edge values at the center of the top-left pixel and their change per pixel (24.8 fixed point)
+    std::array<int64_t, 3> mTopLeftEdge;
+    std::array<int32_t, 3> mDeltaEdgeX;
+    std::array<int32_t, 3> mDeltaEdgeY;
+
+    // Pixel the attribute planes are anchored at. This is the top-left pixel of the unclipped bounding box,
+    // so every scissor region (tile) evaluates the planes identically.
+    int32_t mPlaneOriginX;
+    int32_t mPlaneOriginY;
+
+    // Attributes divided by w, which are linear in screen space
+    AttributePlane mInvW;
+    AttributePlane mUOverW;
+    AttributePlane mVOverW;
+    AttributePlane mLightOverW;
+
+    // Constant inputs of untextured and flat lit pipelines
+    uint32_t mColor;
+    float mFlatIntensity;
+};
 
 //------------------------------------------------------------------------------
-static int32_t EdgeCrossProduct(const glm::ivec2& a, const glm::ivec2& b, const glm::ivec2 point)
+struct SpanState
 {
-    return (b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x);
+    std::array<int32_t, 3> mEdge;       // Fill rule biased edge values at the first pixel (zero for untested edges)
+    std::array<int32_t, 3> mEdgeStepX;  // Edge change per pixel in X (zero for untested edges)
+
+    // Attribute values at the first pixel center
+    float mInvW;
+    float mUOverW;
+    float mVOverW;
+    float mLightOverW;
+};
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+static int64_t EdgeCrossProduct(const glm::ivec2& a, const glm::ivec2& b, const glm::ivec2 point)
+{
+    return static_cast<int64_t>(b.x - a.x) * (point.y - a.y) - static_cast<int64_t>(b.y - a.y) * (point.x - a.x);
+}
+
+//------------------------------------------------------------------------------
+static bool IsTopOrLeftEdge(const glm::ivec2& start, const glm::ivec2& end)
+{
+    const glm::ivec2 edge = end - start;
+
+    const bool isTopEdge = (edge.y == 0) && (edge.x > 0);
+    const bool isLeftEdge = (edge.y < 0);
+
+    return isTopEdge || isLeftEdge;
 }
 
 //------------------------------------------------------------------------------
-static uint32_t LightApplyIntensity(uint32_t originalColor, float percentageFactor) 
+static bool ToSubPixel(const glm::vec4& vertex, glm::ivec2& outPoint)
+{
+    // Written as a negated comparison so that NaN coordinates are rejected as well
+    if (!(std::abs(vertex.x) <= kMaxScreenCoordinate && std::abs(vertex.y) <= kMaxScreenCoordinate))
+    {
+        return false;
+    }
+
+    outPoint.x = static_cast<int32_t>(std::lround(vertex.x * kSubPixelScale));
+    outPoint.y = static_cast<int32_t>(std::lround(vertex.y * kSubPixelScale));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t LightApplyIntensity(uint32_t originalColor, float percentageFactor)
 {
     if (percentageFactor < 0) { percentageFactor = 0; }
     if (percentageFactor > 1) { percentageFactor = 1; }
@@ -36,110 +217,604 @@ static uint32_t LightApplyIntensity(uint32_t originalColor, float percentageFact
     return new_color;
 }
 
+//------------------------------------------------------------------------------
+static uint32_t BlendAlpha(uint32_t source, uint32_t destination)
+{
+    // Source over destination with the source alpha (lowest byte of RGBA8888)
+    const uint32_t alpha = source & 0xFF;
+    const uint32_t inverseAlpha = 255 - alpha;
+
+    uint32_t result = alpha + ((destination & 0xFF) * inverseAlpha + 127) / 255;
+    for (uint32_t shift = 8; shift < 32; shift += 8)
+    {
+        const uint32_t sourceChannel = (source >> shift) & 0xFF;
+        const uint32_t destinationChannel = (destination >> shift) & 0xFF;
+        result |= ((sourceChannel * alpha + destinationChannel * inverseAlpha + 127) / 255) << shift;
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// Mip level whose texels are closest to the size of a pixel. The texture coordinate derivatives follow from
+// the attribute planes, du/dx = w * (d(u/w)/dx - u * d(1/w)/dx), so no neighbor pixels are needed.
+static size_t SelectTextureLevel(const TriangleSetup& setup, const Texture& texture, float u, float v, float w)
+{
+    const glm::vec2 texSize = glm::vec2(texture.GetSize());
+    const float dudx = w * (setup.mUOverW.mStepX - u * setup.mInvW.mStepX) * texSize.x;
+    const float dvdx = w * (setup.mVOverW.mStepX - v * setup.mInvW.mStepX) * texSize.y;
+    const float dudy = w * (setup.mUOverW.mStepY - u * setup.mInvW.mStepY) * texSize.x;
+    const float dvdy = w * (setup.mVOverW.mStepY - v * setup.mInvW.mStepY) * texSize.y;
+
+    // Texels per pixel along the axis with the larger footprint, squared
+    const float footprint = std::max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+
+    // Magnified, written as a negated comparison so that NaN selects the base level as well
+    if (!(footprint > 0.5f))
+    {
+        return 0;
+    }
+
+    // Nearest level, floor(log2(sqrt(footprint)) + 0.5) is the exponent of 2 * footprint halved
+    const size_t level = static_cast<size_t>(std::ilogb(2.0f * footprint) / 2);
+    return std::min(level, texture.GetLevelCount() - 1);
+}
+
+//------------------------------------------------------------------------------
+// Computes the color of one pixel that passed the coverage and depth tests
+template<uint32_t Key>
+static uint32_t ShadeFragment(const TriangleSetup& setup, const Texture* texture, float u, float v, size_t textureLevel, float light,
+                              uint32_t destination)
+{
+    constexpr RasterPipeline kPipeline = DecodePipeline(Key);
+
+    uint32_t color = setup.mColor;
+    if constexpr (kPipeline.mTextured)
+    {
+        if constexpr (kPipeline.mFilter == TextureFilter::Bilinear)
+        {
+            color = SampleBilinear<kPipeline.mSampler, kPipeline.mFormat, kPipeline.mLayout>(*texture, u, v, textureLevel);
+        }
+        else
+        {
+            color = SampleNearest<kPipeline.mSampler, kPipeline.mFormat, kPipeline.mLayout>(*texture, u, v, textureLevel);
+        }
+
+        if constexpr (kPipeline.mLighting == LightingMode::Flat)
+        {
+            color = LightApplyIntensity(color, setup.mFlatIntensity);
+        }
+    }
+
+    // Flat lighting of untextured triangles is folded into the setup color
+    if constexpr (kPipeline.mLighting == LightingMode::Smooth)
+    {
+        color = LightApplyIntensity(color, light);
+    }
+
+    if constexpr (kPipeline.mBlend == BlendMode::Alpha)
+    {
+        color = BlendAlpha(color, destination);
+    }
+
+    (void)texture;
+    (void)u;
+    (void)v;
+    (void)textureLevel;
+    (void)light;
+    (void)destination;
+    return color;
+}
 
 //------------------------------------------------------------------------------
-void DrawTexturedTriangle(ColorBuffer& colorBuffer, ZBuffer& zbuffer, const std::array<glm::vec4, 3>& vertices, const std::array<glm::vec2, 3>& uvs, 
-                          const std::array<float, 3>& intensity, const Texture& texture)
+// Snaps the vertices and computes the bounding box, the edge functions and the attribute plane equations.
+// Returns false when the triangle covers no pixel inside the scissor region.
+template<uint32_t Key>
+static bool SetupTriangle(const Triangle& triangle, FillRule fillRule, const ScissorRect& scissor, TriangleSetup& setup)
 {
-    // Vertex positions (integer screen coordinates)
-    glm::ivec2 p0 = vertices[0];
-    glm::ivec2 p1 = vertices[1];
-    glm::ivec2 p2 = vertices[2];
+    constexpr RasterPipeline kPipeline = DecodePipeline(Key);
+
+    const std::array<Vertex, 3>& vertices = triangle.mVertices;
+
+    // Vertex positions (28.4 fixed point screen coordinates)
+    glm::ivec2 p0;
+    glm::ivec2 p1;
+    glm::ivec2 p2;
+    if (!ToSubPixel(vertices[0].mPoint, p0) || !ToSubPixel(vertices[1].mPoint, p1) || !ToSubPixel(vertices[2].mPoint, p2))
+    {
+        return false;
+    }
+
+    // Twice the signed area, back facing and degenerate triangles cover no pixels
+    const int64_t triangleArea = EdgeCrossProduct(p0, p1, p2);
+    if (triangleArea <= 0)
+    {
+        return false;
+    }
+
+    // Bounding box of the pixels whose centers can be inside the triangle
+    const int32_t xMin = (std::min({ p0.x, p1.x, p2.x }) - kHalfPixel + kSubPixelMask) >> kSubPixelBits;
+    const int32_t yMin = (std::min({ p0.y, p1.y, p2.y }) - kHalfPixel + kSubPixelMask) >> kSubPixelBits;
+    const int32_t xMax = ((std::max({ p0.x, p1.x, p2.x }) - kHalfPixel) >> kSubPixelBits) + 1;
+    const int32_t yMax = ((std::max({ p0.y, p1.y, p2.y }) - kHalfPixel) >> kSubPixelBits) + 1;
+
+    // Restrict rasterization to the scissor region (e.g. the tile being drawn)
+    setup.mXMin = std::max(xMin, scissor.mMinX);
+    setup.mYMin = std::max(yMin, scissor.mMinY);
+    setup.mXMax = std::min(xMax, scissor.mMaxX);
+    setup.mYMax = std::min(yMax, scissor.mMaxY);
+
+    if (setup.mXMin >= setup.mXMax || setup.mYMin >= setup.mYMax)
+    {
+        return false;
+    }
+
+    // Edge function steps for one pixel (24.8 fixed point)
+    setup.mDeltaEdgeX = {
+        (p1.y - p2.y) * kSubPixelScale,
+        (p2.y - p0.y) * kSubPixelScale,
+        (p0.y - p1.y) * kSubPixelScale
+    };
+    setup.mDeltaEdgeY = {
+        (p2.x - p1.x) * kSubPixelScale,
+        (p0.x - p2.x) * kSubPixelScale,
+        (p1.x - p0.x) * kSubPixelScale
+    };
+
+    // Rasterization fill convention. With the top-left rule pixel centers exactly on an edge only belong to
+    // the triangle for which it is a top or left edge, so pixels on shared edges are never shaded twice.
+    std::array<int64_t, 3> fillBias = { 0, 0, 0 };
+    if (fillRule == FillRule::TopLeft)
+    {
+        fillBias = {
+            IsTopOrLeftEdge(p1, p2) ? 0 : -1,
+            IsTopOrLeftEdge(p2, p0) ? 0 : -1,
+            IsTopOrLeftEdge(p0, p1) ? 0 : -1
+        };
+    }
+
+    // Compute edge function values for the center of the top-left pixel
+    const glm::ivec2 topLeftPixel = { setup.mXMin * kSubPixelScale + kHalfPixel, setup.mYMin * kSubPixelScale + kHalfPixel };
+    setup.mTopLeftEdge = {
+        EdgeCrossProduct(p1, p2, topLeftPixel) + fillBias[0],
+        EdgeCrossProduct(p2, p0, topLeftPixel) + fillBias[1],
+        EdgeCrossProduct(p0, p1, topLeftPixel) + fillBias[2]
+    };
+
+    // Constant pipeline inputs
+    setup.mColor = triangle.mColor;
+    setup.mFlatIntensity = vertices[0].mIntensity;
+    if constexpr (!kPipeline.mTextured && kPipeline.mLighting == LightingMode::Flat)
+    {
+        setup.mColor = LightApplyIntensity(triangle.mColor, setup.mFlatIntensity);
+    }
+
+    if constexpr (kPipeline.UsesDepth() || kPipeline.UsesPerspective())
+    {
+        // Unbiased edge values at the plane origin
+        setup.mPlaneOriginX = xMin;
+        setup.mPlaneOriginY = yMin;
+        const glm::ivec2 originPixel = { xMin * kSubPixelScale + kHalfPixel, yMin * kSubPixelScale + kHalfPixel };
+        const std::array<int64_t, 3> originEdge = {
+            EdgeCrossProduct(p1, p2, originPixel),
+            EdgeCrossProduct(p2, p0, originPixel),
+            EdgeCrossProduct(p0, p1, originPixel)
+        };
+
+        // Barycentric weights are the unbiased edge values over the triangle area. An attribute that is linear
+        // in screen space is the weighted sum of its vertex values, and so are its gradients.
+        const float invTriangleArea = 1.0f / static_cast<float>(triangleArea);
+        std::array<AttributePlane, 3> weights;
+        for (size_t i = 0; i < 3; i++)
+        {
+            weights[i].mOrigin = static_cast<float>(originEdge[i]) * invTriangleArea;
+            weights[i].mStepX = setup.mDeltaEdgeX[i] * invTriangleArea;
+            weights[i].mStepY = setup.mDeltaEdgeY[i] * invTriangleArea;
+        }
+
+        auto makePlane = [&weights](float a0, float a1, float a2) -> AttributePlane {
+            return {
+                a0 * weights[0].mOrigin + a1 * weights[1].mOrigin + a2 * weights[2].mOrigin,
+                a0 * weights[0].mStepX + a1 * weights[1].mStepX + a2 * weights[2].mStepX,
+                a0 * weights[0].mStepY + a1 * weights[1].mStepY + a2 * weights[2].mStepY
+            };
+        };
+
+        // Inverse depth and attributes over depth for perspective-correct interpolation
+        const std::array<float, 3> invW = { 1.0f / vertices[0].mPoint.w, 1.0f / vertices[1].mPoint.w, 1.0f / vertices[2].mPoint.w };
+        setup.mInvW = makePlane(invW[0], invW[1], invW[2]);
+
+        if constexpr (kPipeline.mTextured)
+        {
+            setup.mUOverW = makePlane(vertices[0].mUV.x * invW[0], vertices[1].mUV.x * invW[1], vertices[2].mUV.x * invW[2]);
+            setup.mVOverW = makePlane(vertices[0].mUV.y * invW[0], vertices[1].mUV.y * invW[1], vertices[2].mUV.y * invW[2]);
+        }
 
-    // Precompute inverse depth for perspective-correct interpolation
-    float invW0 = 1.0f / vertices[0].w;
-    float invW1 = 1.0f / vertices[1].w;
-    float invW2 = 1.0f / vertices[2].w;
+        if constexpr (kPipeline.mLighting == LightingMode::Smooth)
+        {
+            setup.mLightOverW = makePlane(vertices[0].mIntensity * invW[0], vertices[1].mIntensity * invW[1], vertices[2].mIntensity * invW[2]);
+        }
+    }
 
-    // Texture coordinates for each vertex
-    glm::vec2 uv0 = uvs[0];
-    glm::vec2 uv1 = uvs[1];
-    glm::vec2 uv2 = uvs[2];
+    return true;
+}
 
-    // Compute inverse area for barycentric interpolation
-    float invTriangleArea = 1.0f / static_cast<float>(EdgeCrossProduct(p0, p1, p2));
+#if CPU_SSE2
+//------------------------------------------------------------------------------
+// Index of the lowest set bit of a non-zero four lane mask
+static int32_t FindFirstLane(int32_t laneMask)
+{
+    int32_t lane = 0;
+    while ((laneMask & (1 << lane)) == 0)
+    {
+        lane++;
+    }
+    return lane;
+}
 
-    // Compute bounding box
-    int32_t xMin = std::min({ p0.x, p1.x, p2.x });
-    int32_t yMin = std::min({ p0.y, p1.y, p2.y });
-    int32_t xMax = std::max({ p0.x, p1.x, p2.x });
-    int32_t yMax = std::max({ p0.y, p1.y, p2.y });
+//------------------------------------------------------------------------------
+// Shades the pixels [xStart, xEnd) of a row four at a time, starting from the span state of pixel xStart.
+// When TestCoverage is false the caller guarantees that every pixel of the span is inside the triangle.
+template<uint32_t Key, bool TestCoverage>
+static void ShadeSpan(const TriangleSetup& setup, const Texture* texture, uint32_t* pixelRow, float* depthRow,
+                      int32_t xStart, int32_t xEnd, const SpanState& span)
+{
+    constexpr RasterPipeline kPipeline = DecodePipeline(Key);
 
-    // Precompute edge function step deltas for rasterization
-    int deltaEdge0X = (p1.y - p2.y);
-    int deltaEdge1X = (p2.y - p0.y);
-    int deltaEdge2X = (p0.y - p1.y);
-    int deltaEdge0Y = (p2.x - p1.x);
-    int deltaEdge1Y = (p0.x - p2.x);
-    int deltaEdge2Y = (p1.x - p0.x);
+    const __m128i laneIndex = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128 laneOffset = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128i minusOne = _mm_set1_epi32(-1);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
 
-    // Compute edge function values for the top-left pixel
-    glm::ivec2 topLeftPixel = { xMin, yMin };
-    int32_t edge0 = EdgeCrossProduct(p1, p2, topLeftPixel);
-    int32_t edge1 = EdgeCrossProduct(p2, p0, topLeftPixel);
-    int32_t edge2 = EdgeCrossProduct(p0, p1, topLeftPixel);
+    // Per-lane edge values, lanes cover the pixels x, x + 1, x + 2 and x + 3
+    const std::array<int32_t, 3>& dX = span.mEdgeStepX;
+    __m128i e0 = _mm_add_epi32(_mm_set1_epi32(span.mEdge[0]), _mm_setr_epi32(0, dX[0], 2 * dX[0], 3 * dX[0]));
+    __m128i e1 = _mm_add_epi32(_mm_set1_epi32(span.mEdge[1]), _mm_setr_epi32(0, dX[1], 2 * dX[1], 3 * dX[1]));
+    __m128i e2 = _mm_add_epi32(_mm_set1_epi32(span.mEdge[2]), _mm_setr_epi32(0, dX[2], 2 * dX[2], 3 * dX[2]));
+    const __m128i stepEdge0 = _mm_set1_epi32(4 * dX[0]);
+    const __m128i stepEdge1 = _mm_set1_epi32(4 * dX[1]);
+    const __m128i stepEdge2 = _mm_set1_epi32(4 * dX[2]);
 
-    // Texture size for coordinate clamping
-    const glm::ivec2 texSize = texture.GetSize();
+    // Per-lane attribute values. Attributes a pipeline does not use are never read, so the compiler drops their stepping.
+    __m128 invW = _mm_add_ps(_mm_set1_ps(span.mInvW), _mm_mul_ps(laneOffset, _mm_set1_ps(setup.mInvW.mStepX)));
+    __m128 uOverW = _mm_add_ps(_mm_set1_ps(span.mUOverW), _mm_mul_ps(laneOffset, _mm_set1_ps(setup.mUOverW.mStepX)));
+    __m128 vOverW = _mm_add_ps(_mm_set1_ps(span.mVOverW), _mm_mul_ps(laneOffset, _mm_set1_ps(setup.mVOverW.mStepX)));
+    __m128 lightOverW = _mm_add_ps(_mm_set1_ps(span.mLightOverW), _mm_mul_ps(laneOffset, _mm_set1_ps(setup.mLightOverW.mStepX)));
+    const __m128 stepInvW = _mm_set1_ps(4.0f * setup.mInvW.mStepX);
+    const __m128 stepUOverW = _mm_set1_ps(4.0f * setup.mUOverW.mStepX);
+    const __m128 stepVOverW = _mm_set1_ps(4.0f * setup.mVOverW.mStepX);
+    const __m128 stepLightOverW = _mm_set1_ps(4.0f * setup.mLightOverW.mStepX);
 
-    // Loop over the bounding box (rasterization)
-    for (int32_t y = yMin; y < yMax; y++)
+    for (int32_t x = xStart; x < xEnd; x += 4)
     {
-        int32_t e0 = edge0;
-        int32_t e1 = edge1;
-        int32_t e2 = edge2;
+        // A pixel is covered when all three edge functions are non-negative (sign bit of the OR is clear)
+        const bool isFullSpan = (x + 4 <= xEnd);
+        __m128i laneCoverage = _mm_cmplt_epi32(_mm_add_epi32(_mm_set1_epi32(x), laneIndex), _mm_set1_epi32(xEnd));
+        if constexpr (TestCoverage)
+        {
+            laneCoverage = _mm_and_si128(laneCoverage, _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), minusOne));
+        }
+        __m128 writeMask = _mm_castsi128_ps(laneCoverage);
 
-        for (int32_t x = xMin; x < xMax; x++)
+        if (_mm_movemask_ps(writeMask) != 0)
         {
-            // Check if the pixel is inside the triangle
-            if (e0 >= 0 && e1 >= 0 && e2 >= 0)
+            // Z-buffer test (lanes past the span end read as the cleared depth)
+            alignas(16) float depths[4] = { };
+            alignas(16) float currentDepths[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            if constexpr (kPipeline.UsesDepth())
             {
-                // Compute barycentric weights
-                float alpha = e0 * invTriangleArea;
-                float beta = e1 * invTriangleArea;
-                float gamma = e2 * invTriangleArea;
-
-                // Perspective-correct depth interpolation
-                float interpolatedInvW = alpha * invW0 + beta * invW1 + gamma * invW2;
-                float depth = 1.0f - interpolatedInvW;
-
-                // Z-buffer test
-                float currentDepth = zbuffer.GetDepth(x, y);
-                if (depth < currentDepth)
+                const __m128 depth = _mm_sub_ps(one, invW);
+                _mm_store_ps(depths, depth);
+
+                if (isFullSpan)
+                {
+                    _mm_store_ps(currentDepths, _mm_loadu_ps(depthRow + x));
+                }
+                else
+                {
+                    std::copy(depthRow + x, depthRow + xEnd, currentDepths);
+                }
+
+                if constexpr (kPipeline.mDepthTest)
+                {
+                    writeMask = _mm_and_ps(writeMask, _mm_cmplt_ps(depth, _mm_load_ps(currentDepths)));
+                }
+            }
+
+            const int32_t laneMask = _mm_movemask_ps(writeMask);
+
+            if (laneMask != 0)
+            {
+                alignas(16) float laneU[4] = { };
+                alignas(16) float laneV[4] = { };
+                alignas(16) float laneLight[4] = { };
+                size_t textureLevel = 0;
+                if constexpr (kPipeline.UsesPerspective())
+                {
+                    // Perspective-correct attribute interpolation, one reciprocal for all attributes
+                    const __m128 w = _mm_div_ps(one, invW);
+
+                    if constexpr (kPipeline.mTextured)
+                    {
+                        alignas(16) float laneW[4];
+                        _mm_store_ps(laneW, w);
+                        _mm_store_ps(laneU, _mm_mul_ps(uOverW, w));
+                        _mm_store_ps(laneV, _mm_mul_ps(vOverW, w));
+
+                        // One mip level for the four pixels, taken at the first one that is written. Lanes outside of
+                        // the triangle extrapolate 1/w, it can reach zero or flip sign and blow up the footprint.
+                        const int32_t firstLane = FindFirstLane(laneMask);
+                        textureLevel = SelectTextureLevel(setup, *texture, laneU[firstLane], laneV[firstLane], laneW[firstLane]);
+                    }
+
+                    if constexpr (kPipeline.mLighting == LightingMode::Smooth)
+                    {
+                        _mm_store_ps(laneLight, _mm_max_ps(zero, _mm_min_ps(one, _mm_mul_ps(lightOverW, w))));
+                    }
+                }
+
+                // Texel fetches are gathers and blending reads the destination, so shading runs per active lane
+                alignas(16) uint32_t colors[4] = { };
+                for (int32_t lane = 0; lane < 4; lane++)
                 {
-                    // Perspective-correct UV interpolation
-                    float u = (alpha * (uv0.x * invW0) + beta * (uv1.x * invW1) + gamma * (uv2.x * invW2)) / interpolatedInvW;
-                    float v = (alpha * (uv0.y * invW0) + beta * (uv1.y * invW1) + gamma * (uv2.y * invW2)) / interpolatedInvW;
-                    
-					float interpolatedIntensity  = (alpha * (intensity[0] * invW0) + beta * (intensity[1] * invW1) + gamma * (intensity[2] * invW2)) / interpolatedInvW;
-					interpolatedIntensity = std::max(0.0f, std::min(1.0f, interpolatedIntensity));
-
-                    // Convert UV to texture coordinates (modulo for wrapping)
-                    int32_t texX = static_cast<int32_t>(u * (texSize.x - 1)) % texSize.x;
-                    int32_t texY = static_cast<int32_t>(v * (texSize.y - 1)) % texSize.y;
-                    if (texX < 0) texX += texSize.x;
-                    if (texY < 0) texY += texSize.y;
-
-                    // Fetch texel color and render pixel
-                    uint32_t color = LightApplyIntensity(texture.GetPixel(texX, texY), interpolatedIntensity);
-                    colorBuffer.SetPixel(x, y, color);
-                    zbuffer.SetDepth(x, y, depth);
+                    if (laneMask & (1 << lane))
+                    {
+                        colors[lane] = ShadeFragment<Key>(setup, texture, laneU[lane], laneV[lane], textureLevel, laneLight[lane], pixelRow[x + lane]);
+                    }
+                }
+
+                // Masked stores into the color and depth buffers
+                if (isFullSpan)
+                {
+                    const __m128i colorMask = _mm_castps_si128(writeMask);
+                    __m128i* pixelAddress = reinterpret_cast<__m128i*>(pixelRow + x);
+                    const __m128i oldColors = _mm_loadu_si128(pixelAddress);
+                    const __m128i newColors = _mm_load_si128(reinterpret_cast<const __m128i*>(colors));
+                    _mm_storeu_si128(pixelAddress, _mm_or_si128(_mm_and_si128(colorMask, newColors), _mm_andnot_si128(colorMask, oldColors)));
+
+                    if constexpr (kPipeline.mDepthWrite)
+                    {
+                        const __m128 oldDepths = _mm_load_ps(currentDepths);
+                        const __m128 newDepths = _mm_load_ps(depths);
+                        _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(writeMask, newDepths), _mm_andnot_ps(writeMask, oldDepths)));
+                    }
+                }
+                else
+                {
+                    for (int32_t lane = 0; lane < 4; lane++)
+                    {
+                        if (laneMask & (1 << lane))
+                        {
+                            pixelRow[x + lane] = colors[lane];
+
+                            if constexpr (kPipeline.mDepthWrite)
+                            {
+                                depthRow[x + lane] = depths[lane];
+                            }
+                        }
+                    }
                 }
             }
+        }
+
+        // Step edge functions and attributes four pixels in X direction
+        e0 = _mm_add_epi32(e0, stepEdge0);
+        e1 = _mm_add_epi32(e1, stepEdge1);
+        e2 = _mm_add_epi32(e2, stepEdge2);
+        invW = _mm_add_ps(invW, stepInvW);
+        uOverW = _mm_add_ps(uOverW, stepUOverW);
+        vOverW = _mm_add_ps(vOverW, stepVOverW);
+        lightOverW = _mm_add_ps(lightOverW, stepLightOverW);
+    }
+}
+#else
+//------------------------------------------------------------------------------
+// Shades the pixels [xStart, xEnd) of a row, starting from the span state of pixel xStart.
+// When TestCoverage is false the caller guarantees that every pixel of the span is inside the triangle.
+template<uint32_t Key, bool TestCoverage>
+static void ShadeSpan(const TriangleSetup& setup, const Texture* texture, uint32_t* pixelRow, float* depthRow,
+                      int32_t xStart, int32_t xEnd, const SpanState& span)
+{
+    constexpr RasterPipeline kPipeline = DecodePipeline(Key);
+
+    int32_t e0 = span.mEdge[0];
+    int32_t e1 = span.mEdge[1];
+    int32_t e2 = span.mEdge[2];
+
+    // Attributes a pipeline does not use are never read, so the compiler drops their stepping
+    float invW = span.mInvW;
+    float uOverW = span.mUOverW;
+    float vOverW = span.mVOverW;
+    float lightOverW = span.mLightOverW;
+
+    // Mip levels are selected per group of four pixels from xStart at the first written pixel, like the SSE2 kernel
+    int32_t levelGroup = -1;
+    size_t textureLevel = 0;
+
+    for (int32_t x = xStart; x < xEnd; x++)
+    {
+        // Check if the pixel is inside the triangle
+        if (!TestCoverage || (e0 >= 0 && e1 >= 0 && e2 >= 0))
+        {
+            const float depth = 1.0f - invW;
+
+            // Z-buffer test
+            bool isVisible = true;
+            if constexpr (kPipeline.mDepthTest)
+            {
+                isVisible = depth < depthRow[x];
+            }
+
+            if (isVisible)
+            {
+                float u = 0.0f;
+                float v = 0.0f;
+                float interpolatedIntensity = 0.0f;
+                if constexpr (kPipeline.UsesPerspective())
+                {
+                    // Perspective-correct attribute interpolation, one reciprocal for all attributes
+                    const float w = 1.0f / invW;
+                    u = uOverW * w;
+                    v = vOverW * w;
 
-            // Step edge functions in X direction
-            e0 += deltaEdge0X;
-            e1 += deltaEdge1X;
-            e2 += deltaEdge2X;
+                    if constexpr (kPipeline.mTextured)
+                    {
+                        const int32_t group = (x - xStart) / 4;
+                        if (group != levelGroup)
+                        {
+                            textureLevel = SelectTextureLevel(setup, *texture, u, v, w);
+                            levelGroup = group;
+                        }
+                    }
+
+                    interpolatedIntensity = lightOverW * w;
+                    interpolatedIntensity = std::max(0.0f, std::min(1.0f, interpolatedIntensity));
+                }
+
+                pixelRow[x] = ShadeFragment<Key>(setup, texture, u, v, textureLevel, interpolatedIntensity, pixelRow[x]);
+
+                if constexpr (kPipeline.mDepthWrite)
+                {
+                    depthRow[x] = depth;
+                }
+            }
         }
 
-        // Step edge functions in Y direction
-        edge0 += deltaEdge0Y;
-        edge1 += deltaEdge1Y;
-        edge2 += deltaEdge2Y;
+        // Step edge functions and attributes in X direction
+        e0 += span.mEdgeStepX[0];
+        e1 += span.mEdgeStepX[1];
+        e2 += span.mEdgeStepX[2];
+        invW += setup.mInvW.mStepX;
+        uOverW += setup.mUOverW.mStepX;
+        vOverW += setup.mVOverW.mStepX;
+        lightOverW += setup.mLightOverW.mStepX;
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+template<uint32_t Key>
+static void RasterizeTriangle(ColorBuffer& colorBuffer, ZBuffer& zbuffer, const RenderState& renderState, const Triangle& triangle,
+                              const Texture* texture, const ScissorRect& scissor)
+{
+    constexpr RasterPipeline kPipeline = DecodePipeline(Key);
+
+    TriangleSetup setup;
+    if (!SetupTriangle<Key>(triangle, renderState.mFillRule, scissor, setup))
+    {
+        return;
+    }
+
+    const int32_t xMin = setup.mXMin;
+    const int32_t yMin = setup.mYMin;
+    const int32_t xMax = setup.mXMax;
+    const int32_t yMax = setup.mYMax;
+    const std::array<int32_t, 3>& deltaEdgeX = setup.mDeltaEdgeX;
+    const std::array<int32_t, 3>& deltaEdgeY = setup.mDeltaEdgeY;
+
+    // Walk the bounding box in blocks aligned to the block grid. Edge functions are linear, so evaluating
+    // them at the block corners tells whether a block is fully outside (skipped), fully inside (shaded
+    // without coverage tests) or partially covered (shaded with per-pixel coverage tests).
+    for (int32_t blockY = yMin & ~(kBlockSize - 1); blockY < yMax; blockY += kBlockSize)
+    {
+        const int32_t y0 = std::max(blockY, yMin);
+        const int32_t y1 = std::min(blockY + kBlockSize, yMax) - 1;
+
+        for (int32_t blockX = xMin & ~(kBlockSize - 1); blockX < xMax; blockX += kBlockSize)
+        {
+            const int32_t x0 = std::max(blockX, xMin);
+            const int32_t x1 = std::min(blockX + kBlockSize, xMax) - 1;
+
+            SpanState span { };
+            std::array<int32_t, 3> edgeStepY;
+            bool isOutside = false;
+            bool isInside = true;
+
+            for (size_t i = 0; i < 3; i++)
+            {
+                // Edge value at the top-left pixel of the block
+                const int64_t blockEdge = setup.mTopLeftEdge[i] + static_cast<int64_t>(x0 - xMin) * deltaEdgeX[i] + static_cast<int64_t>(y0 - yMin) * deltaEdgeY[i];
+
+                // Smallest and largest value over the four block corners
+                const int64_t stepX = static_cast<int64_t>(x1 - x0) * deltaEdgeX[i];
+                const int64_t stepY = static_cast<int64_t>(y1 - y0) * deltaEdgeY[i];
+                const int64_t cornerMin = blockEdge + std::min<int64_t>(stepX, 0) + std::min<int64_t>(stepY, 0);
+                const int64_t cornerMax = blockEdge + std::max<int64_t>(stepX, 0) + std::max<int64_t>(stepY, 0);
+
+                isOutside = isOutside || (cornerMax < 0);
+
+                // An edge crossing the block is bounded by the corner range, which always fits in 32 bits.
+                // Edges passing over the whole block are not tested per pixel.
+                const bool isEdgeInside = (cornerMin >= 0);
+                isInside = isInside && isEdgeInside;
+                span.mEdge[i] = isEdgeInside ? 0 : static_cast<int32_t>(blockEdge);
+                span.mEdgeStepX[i] = isEdgeInside ? 0 : deltaEdgeX[i];
+                edgeStepY[i] = isEdgeInside ? 0 : deltaEdgeY[i];
+            }
+
+            if (isOutside)
+            {
+                continue;
+            }
+
+            for (int32_t y = y0; y <= y1; y++)
+            {
+                uint32_t* pixelRow = colorBuffer.GetPixelRow(y);
+                float* depthRow = zbuffer.GetDepthRow(y);
+
+                // Evaluate the plane equations at the start of every row, so stepping errors never build up across rows
+                if constexpr (kPipeline.UsesDepth() || kPipeline.UsesPerspective())
+                {
+                    const int32_t planeX = x0 - setup.mPlaneOriginX;
+                    const int32_t planeY = y - setup.mPlaneOriginY;
+                    span.mInvW = setup.mInvW.At(planeX, planeY);
+                    span.mUOverW = setup.mUOverW.At(planeX, planeY);
+                    span.mVOverW = setup.mVOverW.At(planeX, planeY);
+                    span.mLightOverW = setup.mLightOverW.At(planeX, planeY);
+                }
+
+                if (isInside)
+                {
+                    ShadeSpan<Key, false>(setup, texture, pixelRow, depthRow, x0, x1 + 1, span);
+                }
+                else
+                {
+                    ShadeSpan<Key, true>(setup, texture, pixelRow, depthRow, x0, x1 + 1, span);
+                }
+
+                // Step edge functions in Y direction
+                for (size_t i = 0; i < 3; i++)
+                {
+                    span.mEdge[i] += edgeStepY[i];
+                }
+            }
+        }
     }
 }
 
+//------------------------------------------------------------------------------
+template<uint32_t... Keys>
+static constexpr std::array<RasterTriangleFunc, sizeof...(Keys)> CreatePipelineTable(std::integer_sequence<uint32_t, Keys...>)
+{
+    return { &RasterizeTriangle<Keys>... };
+}
+
+// One rasterizer specialization per combination of per-pixel features
+static constexpr std::array<RasterTriangleFunc, kPipelineCount> kPipelineTable = CreatePipelineTable(std::make_integer_sequence<uint32_t, kPipelineCount>());
+
+//------------------------------------------------------------------------------
+RasterTriangleFunc SelectRasterTriangleFunc(const RenderState& renderState, const Texture* texture)
+{
+    return kPipelineTable[EncodePipeline(renderState, texture)];
+}
+
+//------------------------------------------------------------------------------
+void DrawTriangle(ColorBuffer& colorBuffer, ZBuffer& zbuffer, const RenderState& renderState, const Triangle& triangle, const Texture* texture, const ScissorRect& scissor)
+{
+    SelectRasterTriangleFunc(renderState, texture)(colorBuffer, zbuffer, renderState, triangle, texture, scissor);
+}
+
 //------------------------------------------------------------------------------
 void DrawWireframeTriangle(ColorBuffer& colorBuffer, const std::array<glm::vec4, 3>& vertices, uint32_t color)
 {
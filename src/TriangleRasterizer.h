@@ -2,15 +2,48 @@
 
 // Includes
 //------------------------------------------------------------------------------
+// Application
+#include "RenderState.h"
+#include "Trangle.h"
+
 // Third party
 #include <glm/glm.hpp>
 
+// System
+#include <cstdint>
+
 // Forward Declarations
 //------------------------------------------------------------------------------
 class ColorBuffer;
 class Texture;
 class ZBuffer;
 
+// Constants
+//------------------------------------------------------------------------------
+// Screen positions are snapped to 28.4 fixed point before rasterization. Vertices must lie within
+// +/- kMaxScreenCoordinate pixels, which keeps the 64-bit edge setup and the 32-bit per-pixel edge
+// stepping free of overflow. Triangles reaching further out are not drawn.
+constexpr int32_t kSubPixelBits = 4;
+constexpr float kMaxScreenCoordinate = 16384.0f;
+
+//------------------------------------------------------------------------------
+struct ScissorRect
+{
+    int32_t mMinX;
+    int32_t mMinY;
+    int32_t mMaxX;  // Exclusive
+    int32_t mMaxY;  // Exclusive
+};
+
+// Type Alias
+//------------------------------------------------------------------------------
+// Fills one screen-space triangle with a rasterizer specialization. The texture may be null when texturing is disabled.
+using RasterTriangleFunc = void (*)(ColorBuffer& colorBuffer, ZBuffer& zbuffer, const RenderState& renderState, const Triangle& triangle,
+                                    const Texture* texture, const ScissorRect& scissor);
+
 //------------------------------------------------------------------------------
-void DrawTexturedTriangle(ColorBuffer& colorBuffer, ZBuffer& zbuffer, const std::array<glm::vec4, 3>& vertices, const std::array<glm::vec2, 3>& uvs, const std::array<float, 3>& intensity, const Texture& texture);
+// Selecting once and calling the returned function for every triangle of a draw keeps state decisions out of the raster loop.
+// Textured render states also specialize on the sampler state and size of the texture.
+RasterTriangleFunc SelectRasterTriangleFunc(const RenderState& renderState, const Texture* texture);
+void DrawTriangle(ColorBuffer& colorBuffer, ZBuffer& zbuffer, const RenderState& renderState, const Triangle& triangle, const Texture* texture, const ScissorRect& scissor);
 void DrawWireframeTriangle(ColorBuffer& colorBuffer, const std::array<glm::vec4, 3>& vertices, uint32_t color);
\ No newline at end of file
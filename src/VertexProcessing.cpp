@@ -0,0 +1,146 @@
+#include "VertexProcessing.h"
+
+// Includes
+//------------------------------------------------------------------------------
+// Core
+#include "Core/CpuFeatures.h"
+
+// System
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+void TransformedVertexStream::Resize(size_t count)
+{
+    mViewPoints.Resize(count);
+    mClipPoints.Resize(count);
+    mOutcodes.resize(mClipPoints.GetPaddedSize());
+}
+
+//------------------------------------------------------------------------------
+static void TransformVerticesScalar(const glm::mat4& modelViewMatrix, const glm::mat4& projectionMatrix, const ClipGuardBand& guardBand,
+    const VertexStream<3>& positions, TransformedVertexStream& outVertices)
+{
+    for (size_t i = 0; i < positions.GetSize(); i++)
+    {
+        // Same association as glm's matrix-vector product, so both paths round identically
+        const glm::vec4 viewPoint = modelViewMatrix * glm::vec4(positions.Get(i), 1.0f);
+        const glm::vec4 clipPoint = projectionMatrix * viewPoint;
+
+        outVertices.mViewPoints.Set(i, viewPoint);
+        outVertices.mClipPoints.Set(i, clipPoint);
+        outVertices.mOutcodes[i] = ComputeClipOutcodes(clipPoint, guardBand);
+    }
+}
+
+#if CPU_X86
+//------------------------------------------------------------------------------
+CPU_TARGET_AVX2 static __m256 TransformRowAVX2(const glm::mat4& matrix, int32_t row, __m256 x, __m256 y, __m256 z, __m256 w)
+{
+    // (m0 * x + m1 * y) + (m2 * z + m3 * w), kept unfused to match the scalar path
+    const __m256 xy = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(matrix[0][row]), x), _mm256_mul_ps(_mm256_set1_ps(matrix[1][row]), y));
+    const __m256 zw = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(matrix[2][row]), z), _mm256_mul_ps(_mm256_set1_ps(matrix[3][row]), w));
+    return _mm256_add_ps(xy, zw);
+}
+
+//------------------------------------------------------------------------------
+CPU_TARGET_AVX2 static __m256i OutcodeBitAVX2(__m256 outside, ClippingPlaneType plane)
+{
+    return _mm256_and_si256(_mm256_castps_si256(outside), _mm256_set1_epi32(ClippingPlaneOutcode(plane)));
+}
+
+//------------------------------------------------------------------------------
+CPU_TARGET_AVX2 static __m256i ComputeClipOutcodesAVX2(__m256 x, __m256 y, __m256 z, __m256 w, float extentScaleX, float extentScaleY)
+{
+    // Same comparisons as ComputeClipOutcode, NaN compares false in both
+    const __m256 extentX = _mm256_mul_ps(_mm256_set1_ps(extentScaleX), w);
+    const __m256 extentY = _mm256_mul_ps(_mm256_set1_ps(extentScaleY), w);
+    const __m256 negativeExtentX = _mm256_sub_ps(_mm256_setzero_ps(), extentX);
+    const __m256 negativeExtentY = _mm256_sub_ps(_mm256_setzero_ps(), extentY);
+
+    __m256i outcode = OutcodeBitAVX2(_mm256_cmp_ps(z, _mm256_setzero_ps(), _CMP_LT_OQ), ClippingPlaneType::NEAR);
+    outcode = _mm256_or_si256(outcode, OutcodeBitAVX2(_mm256_cmp_ps(z, w, _CMP_GT_OQ), ClippingPlaneType::FAR));
+    outcode = _mm256_or_si256(outcode, OutcodeBitAVX2(_mm256_cmp_ps(x, negativeExtentX, _CMP_LT_OQ), ClippingPlaneType::LEFT));
+    outcode = _mm256_or_si256(outcode, OutcodeBitAVX2(_mm256_cmp_ps(x, extentX, _CMP_GT_OQ), ClippingPlaneType::RIGHT));
+    outcode = _mm256_or_si256(outcode, OutcodeBitAVX2(_mm256_cmp_ps(y, extentY, _CMP_GT_OQ), ClippingPlaneType::TOP));
+    outcode = _mm256_or_si256(outcode, OutcodeBitAVX2(_mm256_cmp_ps(y, negativeExtentY, _CMP_LT_OQ), ClippingPlaneType::BOTTOM));
+    return outcode;
+}
+
+//------------------------------------------------------------------------------
+CPU_TARGET_AVX2 static void TransformVerticesAVX2(const glm::mat4& modelViewMatrix, const glm::mat4& projectionMatrix, const ClipGuardBand& guardBand,
+    const VertexStream<3>& positions, TransformedVertexStream& outVertices)
+{
+    const float* inX = positions.GetComponent(0);
+    const float* inY = positions.GetComponent(1);
+    const float* inZ = positions.GetComponent(2);
+
+    float* viewX = outVertices.mViewPoints.GetComponent(0);
+    float* viewY = outVertices.mViewPoints.GetComponent(1);
+    float* viewZ = outVertices.mViewPoints.GetComponent(2);
+    float* clipX = outVertices.mClipPoints.GetComponent(0);
+    float* clipY = outVertices.mClipPoints.GetComponent(1);
+    float* clipZ = outVertices.mClipPoints.GetComponent(2);
+    float* clipW = outVertices.mClipPoints.GetComponent(3);
+    ClipOutcodes* outcodes = outVertices.mOutcodes.data();
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    // The streams are padded to whole batches, padding vertices are transformed but never referenced
+    for (size_t i = 0; i < positions.GetPaddedSize(); i += VertexStream<3>::kPadding)
+    {
+        const __m256 x = _mm256_loadu_ps(inX + i);
+        const __m256 y = _mm256_loadu_ps(inY + i);
+        const __m256 z = _mm256_loadu_ps(inZ + i);
+
+        const __m256 vx = TransformRowAVX2(modelViewMatrix, 0, x, y, z, one);
+        const __m256 vy = TransformRowAVX2(modelViewMatrix, 1, x, y, z, one);
+        const __m256 vz = TransformRowAVX2(modelViewMatrix, 2, x, y, z, one);
+        const __m256 vw = TransformRowAVX2(modelViewMatrix, 3, x, y, z, one);
+        _mm256_storeu_ps(viewX + i, vx);
+        _mm256_storeu_ps(viewY + i, vy);
+        _mm256_storeu_ps(viewZ + i, vz);
+
+        const __m256 cx = TransformRowAVX2(projectionMatrix, 0, vx, vy, vz, vw);
+        const __m256 cy = TransformRowAVX2(projectionMatrix, 1, vx, vy, vz, vw);
+        const __m256 cz = TransformRowAVX2(projectionMatrix, 2, vx, vy, vz, vw);
+        const __m256 cw = TransformRowAVX2(projectionMatrix, 3, vx, vy, vz, vw);
+        _mm256_storeu_ps(clipX + i, cx);
+        _mm256_storeu_ps(clipY + i, cy);
+        _mm256_storeu_ps(clipZ + i, cz);
+        _mm256_storeu_ps(clipW + i, cw);
+
+        alignas(32) int32_t viewOutcodes[8];
+        alignas(32) int32_t guardBandOutcodes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(viewOutcodes), ComputeClipOutcodesAVX2(cx, cy, cz, cw, 1.0f, 1.0f));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(guardBandOutcodes), ComputeClipOutcodesAVX2(cx, cy, cz, cw, guardBand.mX, guardBand.mY));
+
+        for (size_t lane = 0; lane < 8; lane++)
+        {
+            outcodes[i + lane].mView = static_cast<uint8_t>(viewOutcodes[lane]);
+            outcodes[i + lane].mGuardBand = static_cast<uint8_t>(guardBandOutcodes[lane]);
+        }
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+void TransformVertices(const glm::mat4& modelViewMatrix, const glm::mat4& projectionMatrix, const ClipGuardBand& guardBand,
+    const VertexStream<3>& positions, TransformedVertexStream& outVertices)
+{
+    if (outVertices.mClipPoints.GetSize() != positions.GetSize())
+    {
+        outVertices.Resize(positions.GetSize());
+    }
+
+#if CPU_X86
+    if (CpuSupportsAVX2())
+    {
+        TransformVerticesAVX2(modelViewMatrix, projectionMatrix, guardBand, positions, outVertices);
+        return;
+    }
+#endif
+
+    TransformVerticesScalar(modelViewMatrix, projectionMatrix, guardBand, positions, outVertices);
+}
\ No newline at end of file
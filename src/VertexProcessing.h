@@ -0,0 +1,36 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// Application
+#include "Clipping.h"
+#include "VertexStream.h"
+
+// Third party
+#include <glm/glm.hpp>
+
+// System
+#include <vector>
+
+/*
+    Post-transform buffer filled by the vertex stage. Every unique mesh position is transformed
+    once per frame, triangles are then assembled by indexing into this buffer instead of
+    transforming each face corner on its own. The outcodes are kept in their own compact array,
+    so trivially rejected faces are culled without touching the positions.
+*/
+//------------------------------------------------------------------------------
+struct TransformedVertexStream
+{
+    VertexStream<3> mViewPoints;    // Used for back-face culling
+    VertexStream<4> mClipPoints;
+    std::vector<ClipOutcodes> mOutcodes;
+
+    void Resize(size_t count);
+};
+
+//------------------------------------------------------------------------------
+// Transforms model-space positions into view and clip space and computes their clip outcodes.
+// Batches of 8 vertices are processed with AVX2 when the CPU supports it. Every code path
+// performs the same operations in the same order, so the results do not depend on the CPU.
+void TransformVertices(const glm::mat4& modelViewMatrix, const glm::mat4& projectionMatrix, const ClipGuardBand& guardBand,
+    const VertexStream<3>& positions, TransformedVertexStream& outVertices);
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+// Includes
+//------------------------------------------------------------------------------
+// Third party
+#include <glm/glm.hpp>
+
+// System
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/*
+    Structure-of-arrays storage for a vertex attribute with ComponentCount float components.
+    Every component lives in its own array, padded with zeros to a multiple of kPadding, so
+    SIMD kernels can load a batch of consecutive vertices per component and never need a
+    scalar tail loop. A stream either owns its arrays or views arrays owned elsewhere, for
+    example a memory-mapped file. Views are read-only.
+*/
+//------------------------------------------------------------------------------
+template<size_t ComponentCount>
+class VertexStream
+{
+public:
+    static constexpr size_t kPadding = 8;  // Floats per AVX register
+
+    static constexpr size_t GetPaddedSize(size_t count) { return (count + kPadding - 1) / kPadding * kPadding; }
+
+    VertexStream() = default;
+    VertexStream(VertexStream&&) = default;
+    VertexStream& operator=(VertexStream&&) = default;
+
+    // Delete copy and assignment, the component pointers would still point into the source
+    VertexStream(const VertexStream&) = delete;
+    VertexStream& operator=(const VertexStream&) = delete;
+
+    void Resize(size_t count)
+    {
+        mCount = count;
+        for (size_t component = 0; component < ComponentCount; component++)
+        {
+            mComponents[component].assign(GetPaddedSize(), 0.0f);
+            mData[component] = mComponents[component].data();
+        }
+    }
+
+    // Views external component arrays, each padded to GetPaddedSize(count) floats
+    void View(const std::array<const float*, ComponentCount>& components, size_t count)
+    {
+        mCount = count;
+        mComponents = { };
+        mData = components;
+    }
+
+    bool IsView() const { return mCount > 0 && mData[0] != mComponents[0].data(); }
+
+    size_t GetSize() const { return mCount; }
+    size_t GetPaddedSize() const { return GetPaddedSize(mCount); }
+
+    float* GetComponent(size_t component)
+    {
+        assert(!IsView() && "Error: Vertex stream views are read-only!");
+        return mComponents[component].data();
+    }
+    const float* GetComponent(size_t component) const { return mData[component]; }
+
+    auto Get(size_t index) const
+    {
+        if constexpr (ComponentCount == 2)
+        {
+            return glm::vec2(mData[0][index], mData[1][index]);
+        }
+        else if constexpr (ComponentCount == 3)
+        {
+            return glm::vec3(mData[0][index], mData[1][index], mData[2][index]);
+        }
+        else
+        {
+            static_assert(ComponentCount == 4, "Error: Unsupported component count!");
+            return glm::vec4(mData[0][index], mData[1][index], mData[2][index], mData[3][index]);
+        }
+    }
+
+    template<typename VectorType>
+    void Set(size_t index, const VectorType& value)
+    {
+        assert(!IsView() && "Error: Vertex stream views are read-only!");
+        for (size_t component = 0; component < ComponentCount; component++)
+        {
+            mComponents[component][index] = value[static_cast<glm::length_t>(component)];
+        }
+    }
+
+private:
+    std::array<std::vector<float>, ComponentCount> mComponents;
+    std::array<const float*, ComponentCount> mData { };
+    size_t mCount = 0;
+};
\ No newline at end of file
@@ -22,6 +22,10 @@ public:
     void SetDepth(int32_t x, int32_t y, float depth);
     float GetDepth(int32_t x, int32_t y) const;
 
+    // Unchecked access for rasterizers that already clip to the buffer bounds
+    float* GetDepthRow(int32_t y) { return mBuffer.data() + y * mSize.x; }
+    const glm::ivec2& GetSize() const { return mSize; }
+
 private:
     std::vector<float> mBuffer;
     glm::ivec2 mSize;